@@ -0,0 +1,70 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#include <algorithm>
+#include <vector>
+
+#include "bench_util.h"
+#include "rend_accum_buffer.h"
+#include "util_pass.h"
+
+bool bench_accum_buffer(const BenchOptions& options)
+{
+	const int width = options.quick ? 320 : 3840;
+	const int height = options.quick ? 180 : 2160;
+	const int tile_size = 64;
+
+	std::vector<RenderPassInfo> pass_info_vec;
+	pass_info_vec.push_back(RenderPassInfo());
+	pass_info_vec.push_back(RenderPassInfo(RenderPassType::NORMAL, ccl::PassType::PASS_NORMAL, 4, "__normal", 0));
+	pass_info_vec.push_back(RenderPassInfo(RenderPassType::DEPTH, ccl::PassType::PASS_DEPTH, 1, "__depth", 0));
+	pass_info_vec.push_back(RenderPassInfo(RenderPassType::MIST, ccl::PassType::PASS_MIST, 1, "__mist", 0));
+
+	const size_t num_pixels = static_cast<size_t>(width) * height;
+
+	const double init_ms = bench_median_ms(options.iterations(), [&]() {
+		AccumulationBuffer buffer(width, height, pass_info_vec);
+	});
+	bench_report("AccumulationBuffer init 4 passes", num_pixels, init_ms);
+
+	// Copy a frame's worth of tiles into the combined pass, the same access pattern as the tile callbacks
+	AccumulationBuffer buffer(width, height, pass_info_vec);
+	const std::vector<float> tile(tile_size * tile_size * 4, 0.5f);
+	const double copy_ms = bench_median_ms(options.iterations(), [&]() {
+		float* const combined = buffer.get_pass_buffer("Combined");
+		for (int tile_y = 0; tile_y < height; tile_y += tile_size) {
+			for (int tile_x = 0; tile_x < width; tile_x += tile_size) {
+				const int copy_width = std::min(tile_size, width - tile_x);
+				const int copy_height = std::min(tile_size, height - tile_y);
+				for (int y = 0; y < copy_height; y++) {
+					const float* const src = tile.data() + static_cast<size_t>(y) * tile_size * 4;
+					float* const dest = combined + (static_cast<size_t>(tile_y + y) * width + tile_x) * 4;
+					std::copy(src, src + copy_width * 4, dest);
+				}
+			}
+		}
+	});
+	bench_report("AccumulationBuffer tile copy combined", num_pixels, copy_ms);
+
+	const float* const depth = buffer.get_pass_buffer("__depth00");
+	const float* const normal = buffer.get_pass_buffer("__normal00");
+	if (depth[num_pixels - 1] != 0.0f || normal[num_pixels * 4 - 1] != 1.0f) {
+		return bench_fail("AccumulationBuffer", "passes were not initialized");
+	}
+
+	return true;
+}
@@ -0,0 +1,47 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#include <vector>
+
+#include "bench_util.h"
+#include "util_half.h"
+
+bool bench_half(const BenchOptions& options)
+{
+	const size_t num_pixels = options.quick ? 64 * 1024 : 3840 * 2160;
+
+	// 0x3C00 is 1.0 and 0x3800 is 0.5 in half precision
+	std::vector<pluginHalf> half_pixels(num_pixels * 4);
+	for (size_t i = 0; i < half_pixels.size(); i++) {
+		half_pixels[i] = (i % 4 == 3) ? 0x3C00 : 0x3800;
+	}
+
+	std::vector<ccl::float4> float_pixels(num_pixels);
+	const double convert_ms = bench_median_ms(options.iterations(), [&]() {
+		for (size_t i = 0; i < num_pixels; i++) {
+			float_pixels[i] = float4_from_half_array(half_pixels.data() + i * 4);
+		}
+	});
+	bench_report("float4_from_half_array", num_pixels, convert_ms);
+
+	const ccl::float4 last = float_pixels[num_pixels - 1];
+	if (last.x != 0.5f || last.y != 0.5f || last.z != 0.5f || last.w != 1.0f) {
+		return bench_fail("float4_from_half_array", "unexpected conversion result");
+	}
+
+	return true;
+}
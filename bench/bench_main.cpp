@@ -0,0 +1,62 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+/**
+ * @file
+ * @brief Entry point for the microbenchmarks, pass --quick to run each benchmark once with small inputs.
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "bench_util.h"
+
+bool bench_mikktspace(const BenchOptions& options);
+bool bench_smooth_groups(const BenchOptions& options);
+
+#ifdef BENCH_WITH_CYCLES
+bool bench_accum_buffer(const BenchOptions& options);
+bool bench_half(const BenchOptions& options);
+bool bench_sphere_mesh(const BenchOptions& options);
+#endif
+
+int main(const int argc, const char* const argv[])
+{
+	BenchOptions options;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--quick") == 0) {
+			options.quick = true;
+		}
+		else {
+			std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+			return 2;
+		}
+	}
+
+	bool success = true;
+
+	success = bench_mikktspace(options) && success;
+	success = bench_smooth_groups(options) && success;
+
+#ifdef BENCH_WITH_CYCLES
+	success = bench_accum_buffer(options) && success;
+	success = bench_half(options) && success;
+	success = bench_sphere_mesh(options) && success;
+#endif
+
+	return success ? 0 : 1;
+}
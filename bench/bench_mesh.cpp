@@ -0,0 +1,158 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#include "bench_mesh.h"
+
+#include <cmath>
+
+#include "extern_mikktspace.h"
+
+static float grid_height(const float x, const float y)
+{
+	return 0.25f * std::sin(x * 5.0f) * std::cos(y * 3.0f);
+}
+
+BenchMesh make_grid_mesh(const int cells_x, const int cells_y, const bool quads)
+{
+	BenchMesh result;
+	result.verts_per_face = quads ? 4 : 3;
+
+	const int verts_x = cells_x + 1;
+	const int verts_y = cells_y + 1;
+	for (int y = 0; y < verts_y; y++) {
+		for (int x = 0; x < verts_x; x++) {
+			const float fx = static_cast<float>(x) / cells_x;
+			const float fy = static_cast<float>(y) / cells_y;
+			result.positions.push_back(fx);
+			result.positions.push_back(fy);
+			result.positions.push_back(grid_height(fx, fy));
+		}
+	}
+
+	const auto add_corner = [&result, verts_x, cells_x, cells_y](const int x, const int y) {
+		const float fx = static_cast<float>(x) / cells_x;
+		const float fy = static_cast<float>(y) / cells_y;
+
+		// Analytic normal of the height field
+		const float eps = 1.0e-3f;
+		const float dx = (grid_height(fx + eps, fy) - grid_height(fx - eps, fy)) / (2.0f * eps);
+		const float dy = (grid_height(fx, fy + eps) - grid_height(fx, fy - eps)) / (2.0f * eps);
+		const float len = std::sqrt(dx * dx + dy * dy + 1.0f);
+
+		result.face_verts.push_back(y * verts_x + x);
+		result.corner_normals.push_back(-dx / len);
+		result.corner_normals.push_back(-dy / len);
+		result.corner_normals.push_back(1.0f / len);
+		result.corner_uvs.push_back(fx);
+		result.corner_uvs.push_back(fy);
+	};
+
+	for (int y = 0; y < cells_y; y++) {
+		for (int x = 0; x < cells_x; x++) {
+			if (quads) {
+				add_corner(x, y);
+				add_corner(x + 1, y);
+				add_corner(x + 1, y + 1);
+				add_corner(x, y + 1);
+			}
+			else {
+				add_corner(x, y);
+				add_corner(x + 1, y);
+				add_corner(x + 1, y + 1);
+				add_corner(x, y);
+				add_corner(x + 1, y + 1);
+				add_corner(x, y + 1);
+			}
+		}
+	}
+
+	return result;
+}
+
+static const BenchMesh& get_mesh(const SMikkTSpaceContext* const context)
+{
+	return *static_cast<const BenchMesh*>(context->m_pUserData);
+}
+
+static int mikk_get_num_faces(const SMikkTSpaceContext* const context)
+{
+	return static_cast<int>(get_mesh(context).num_faces());
+}
+
+static int mikk_get_num_verts_of_face(const SMikkTSpaceContext* const context, const int /*face*/)
+{
+	return get_mesh(context).verts_per_face;
+}
+
+static void mikk_get_position(const SMikkTSpaceContext* const context, float pos_out[], const int face, const int vert)
+{
+	const BenchMesh& mesh = get_mesh(context);
+	const int vert_index = mesh.face_verts[face * mesh.verts_per_face + vert];
+	pos_out[0] = mesh.positions[vert_index * 3 + 0];
+	pos_out[1] = mesh.positions[vert_index * 3 + 1];
+	pos_out[2] = mesh.positions[vert_index * 3 + 2];
+}
+
+static void mikk_get_normal(const SMikkTSpaceContext* const context, float norm_out[], const int face, const int vert)
+{
+	const BenchMesh& mesh = get_mesh(context);
+	const size_t corner = static_cast<size_t>(face) * mesh.verts_per_face + vert;
+	norm_out[0] = mesh.corner_normals[corner * 3 + 0];
+	norm_out[1] = mesh.corner_normals[corner * 3 + 1];
+	norm_out[2] = mesh.corner_normals[corner * 3 + 2];
+}
+
+static void mikk_get_tex_coord(const SMikkTSpaceContext* const context, float uv_out[], const int face, const int vert)
+{
+	const BenchMesh& mesh = get_mesh(context);
+	const size_t corner = static_cast<size_t>(face) * mesh.verts_per_face + vert;
+	uv_out[0] = mesh.corner_uvs[corner * 2 + 0];
+	uv_out[1] = mesh.corner_uvs[corner * 2 + 1];
+}
+
+static void mikk_set_tspace_basic(const SMikkTSpaceContext* const context, const float tangent[], const float sign, const int face, const int vert)
+{
+	// Each corner is written exactly once so this is safe to call from several threads
+	BenchMesh& mesh = *static_cast<BenchMesh*>(context->m_pUserData);
+	const size_t corner = static_cast<size_t>(face) * mesh.verts_per_face + vert;
+	mesh.corner_tangents[corner * 4 + 0] = tangent[0];
+	mesh.corner_tangents[corner * 4 + 1] = tangent[1];
+	mesh.corner_tangents[corner * 4 + 2] = tangent[2];
+	mesh.corner_tangents[corner * 4 + 3] = sign;
+}
+
+bool generate_tangents(BenchMesh& mesh, const bool use_parallel, const float angular_threshold)
+{
+	mesh.corner_tangents.assign(mesh.face_verts.size() * 4, 0.0f);
+
+	SMikkTSpaceInterface mikk_interface = {};
+	mikk_interface.m_getNumFaces = mikk_get_num_faces;
+	mikk_interface.m_getNumVerticesOfFace = mikk_get_num_verts_of_face;
+	mikk_interface.m_getPosition = mikk_get_position;
+	mikk_interface.m_getNormal = mikk_get_normal;
+	mikk_interface.m_getTexCoord = mikk_get_tex_coord;
+	mikk_interface.m_setTSpaceBasic = mikk_set_tspace_basic;
+
+	SMikkTSpaceContext mikk_context = {};
+	mikk_context.m_pInterface = &mikk_interface;
+	mikk_context.m_pUserData = &mesh;
+
+	if (use_parallel) {
+		return genTangSpaceParallel(&mikk_context, angular_threshold) != 0;
+	}
+	return genTangSpace(&mikk_context, angular_threshold) != 0;
+}
@@ -0,0 +1,62 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#pragma once
+
+/**
+ * @file
+ * @brief Defines a simple mesh type and generators used as benchmark and test input.
+ */
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Mesh with per-corner attributes in the layout MikkTSpace reads, every face has the same vertex count.
+ */
+class BenchMesh {
+public:
+	int verts_per_face = 3;
+
+	// 3 floats per vertex
+	std::vector<float> positions;
+
+	// Vertex index for each face corner
+	std::vector<int> face_verts;
+
+	// 3 floats per face corner
+	std::vector<float> corner_normals;
+
+	// 2 floats per face corner
+	std::vector<float> corner_uvs;
+
+	// 4 floats per face corner, written by generate_tangents
+	std::vector<float> corner_tangents;
+
+	size_t num_verts() const { return positions.size() / 3; }
+	size_t num_faces() const { return face_verts.size() / verts_per_face; }
+};
+
+/**
+ * @brief Returns a wavy height field with cells_x * cells_y cells split into triangles or kept as quads.
+ */
+BenchMesh make_grid_mesh(int cells_x, int cells_y, bool quads);
+
+/**
+ * @brief Fills mesh.corner_tangents with MikkTSpace, returns false if MikkTSpace fails.
+ */
+bool generate_tangents(BenchMesh& mesh, bool use_parallel, float angular_threshold = 180.0f);
@@ -0,0 +1,50 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#include <cstring>
+#include <vector>
+
+#include "bench_mesh.h"
+#include "bench_util.h"
+
+bool bench_mikktspace(const BenchOptions& options)
+{
+	const int cells = options.quick ? 32 : 512;
+
+	for (const bool quads : { false, true }) {
+		BenchMesh mesh = make_grid_mesh(cells, cells, quads);
+		const std::string suffix = quads ? " quads" : " tris";
+
+		const double serial_ms = bench_median_ms(options.iterations(), [&mesh]() {
+			generate_tangents(mesh, false);
+		});
+		const std::vector<float> serial_tangents = mesh.corner_tangents;
+
+		const double parallel_ms = bench_median_ms(options.iterations(), [&mesh]() {
+			generate_tangents(mesh, true);
+		});
+
+		bench_report("mikktspace serial" + suffix, mesh.num_faces(), serial_ms);
+		bench_report("mikktspace parallel" + suffix, mesh.num_faces(), parallel_ms);
+
+		if (std::memcmp(serial_tangents.data(), mesh.corner_tangents.data(), serial_tangents.size() * sizeof(float)) != 0) {
+			return bench_fail("mikktspace" + suffix, "parallel tangents differ from serial tangents");
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,94 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench_mesh.h"
+#include "bench_util.h"
+#include "ref_smooth_groups.h"
+#include "util_smooth_groups.h"
+
+static bool same_split(const SmoothGroupSplit& a, const SmoothGroupSplit& b)
+{
+	return a.total_verts == b.total_verts && a.corner_verts == b.corner_verts && a.duplicated_from == b.duplicated_from;
+}
+
+static std::vector<std::uint32_t> make_smooth_groups(const size_t num_faces, const int pattern)
+{
+	std::mt19937 rng(1234);
+	std::vector<std::uint32_t> result(num_faces);
+	for (size_t i = 0; i < num_faces; i++) {
+		switch (pattern) {
+		case 0:
+			// Fully smooth
+			result[i] = 1;
+			break;
+		case 1:
+			// Every face in its own group, so every shared vertex is split
+			result[i] = 1u << (i % 32);
+			break;
+		default:
+			// Random patches of one to three groups, with some faceted faces
+			result[i] = rng() & 0xFF;
+			break;
+		}
+	}
+	return result;
+}
+
+bool bench_smooth_groups(const BenchOptions& options)
+{
+	const int cells = options.quick ? 32 : 1024;
+	const BenchMesh mesh = make_grid_mesh(cells, cells, false);
+
+	const char* const pattern_names[] = { " smooth", " faceted", " mixed" };
+	for (int pattern = 0; pattern < 3; pattern++) {
+		const std::vector<std::uint32_t> smooth_groups = make_smooth_groups(mesh.num_faces(), pattern);
+		const std::string suffix = pattern_names[pattern];
+
+		SmoothGroupSplit ref_split;
+		const double ref_ms = bench_median_ms(options.iterations(), [&]() {
+			ref_split = ref_split_smoothing_groups(mesh.num_verts(), mesh.num_faces(), mesh.face_verts.data(), smooth_groups.data());
+		});
+
+		SmoothGroupSplit serial_split;
+		const double serial_ms = bench_median_ms(options.iterations(), [&]() {
+			serial_split = split_smoothing_groups(mesh.num_verts(), mesh.num_faces(), mesh.face_verts.data(), smooth_groups.data(), false);
+		});
+
+		SmoothGroupSplit parallel_split;
+		const double parallel_ms = bench_median_ms(options.iterations(), [&]() {
+			parallel_split = split_smoothing_groups(mesh.num_verts(), mesh.num_faces(), mesh.face_verts.data(), smooth_groups.data(), true);
+		});
+
+		bench_report("smoothing groups MultiVertex" + suffix, mesh.num_faces(), ref_ms);
+		bench_report("smoothing groups flat serial" + suffix, mesh.num_faces(), serial_ms);
+		bench_report("smoothing groups flat parallel" + suffix, mesh.num_faces(), parallel_ms);
+
+		if (same_split(ref_split, serial_split) == false) {
+			return bench_fail("smoothing groups" + suffix, "serial output differs from MultiVertex output");
+		}
+		if (same_split(ref_split, parallel_split) == false) {
+			return bench_fail("smoothing groups" + suffix, "parallel output differs from MultiVertex output");
+		}
+	}
+
+	return true;
+}
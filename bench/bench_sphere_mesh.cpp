@@ -0,0 +1,44 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#include <memory>
+
+#include <render/mesh.h>
+
+#include "bench_util.h"
+#include "util_sphere_mesh.h"
+
+bool bench_sphere_mesh(const BenchOptions& options)
+{
+	const int layers = options.quick ? 16 : 512;
+	const int ring_verts = options.quick ? 32 : 1024;
+
+	size_t num_triangles = 0;
+	const double build_ms = bench_median_ms(options.iterations(), [&]() {
+		std::unique_ptr<ccl::Mesh> mesh(get_sphere_mesh(layers, ring_verts, nullptr));
+		num_triangles = mesh->num_triangles();
+	});
+	bench_report("get_sphere_mesh", num_triangles, build_ms);
+
+	// Top and bottom caps plus two triangles per quad on every inner layer
+	const size_t expected_triangles = static_cast<size_t>(ring_verts) * 2 * (layers - 1);
+	if (num_triangles != expected_triangles) {
+		return bench_fail("get_sphere_mesh", "unexpected triangle count");
+	}
+
+	return true;
+}
@@ -0,0 +1,48 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#include "bench_util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+double bench_median_ms(const int iterations, const std::function<void()>& func)
+{
+	std::vector<double> times;
+	for (int i = 0; i < std::max(iterations, 1); i++) {
+		const auto begin = std::chrono::steady_clock::now();
+		func();
+		const auto end = std::chrono::steady_clock::now();
+		times.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+	}
+	std::sort(times.begin(), times.end());
+	return times[times.size() / 2];
+}
+
+void bench_report(const std::string& name, const size_t items, const double median_ms)
+{
+	const double items_per_sec = median_ms > 0.0 ? items / (median_ms / 1000.0) : 0.0;
+	std::printf("%-48s %10.3f ms %14.0f items/s\n", name.c_str(), median_ms, items_per_sec);
+}
+
+bool bench_fail(const std::string& name, const std::string& reason)
+{
+	std::printf("%-48s FAILED: %s\n", name.c_str(), reason.c_str());
+	return false;
+}
@@ -0,0 +1,53 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#pragma once
+
+/**
+ * @file
+ * @brief Defines helpers shared by the microbenchmarks.
+ */
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+/**
+ * @brief Settings passed to every benchmark.
+ */
+class BenchOptions {
+public:
+	// Use small inputs and few iterations, for smoke testing the benchmarks themselves
+	bool quick = false;
+
+	int iterations() const { return quick ? 1 : 7; }
+};
+
+/**
+ * @brief Runs func the given number of times and returns the median run time in milliseconds.
+ */
+double bench_median_ms(int iterations, const std::function<void()>& func);
+
+/**
+ * @brief Prints one line of benchmark results, items is used to report throughput.
+ */
+void bench_report(const std::string& name, size_t items, double median_ms);
+
+/**
+ * @brief Prints a failed correctness check and returns false.
+ */
+bool bench_fail(const std::string& name, const std::string& reason);
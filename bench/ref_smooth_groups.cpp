@@ -0,0 +1,157 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#include "ref_smooth_groups.h"
+
+#include <list>
+#include <vector>
+
+#include "shim/max_types.h"
+
+// SmoothGroupVert and MultiVertex are copied unchanged from the old util_translate_geometry.cpp
+
+class SmoothGroupVert {
+public:
+	SmoothGroupVert(const DWORD smooth_group, const DWORD new_vert) : smooth_group{ smooth_group }, new_vert{ new_vert } {}
+
+	DWORD smooth_group;
+	DWORD new_vert;
+};
+
+class MultiVertex {
+public:
+	MultiVertex(unsigned int vert_index) : vert_index{ vert_index } {}
+
+	int get_vert_index(DWORD smooth_group);
+	void add_smooth_vert(DWORD smooth_group, DWORD vertex);
+	void collapse_list();
+
+	typedef std::list<SmoothGroupVert>::iterator list_iter;
+
+	std::list<SmoothGroupVert> smooth_verts;
+	unsigned int vert_index;
+};
+
+int MultiVertex::get_vert_index(DWORD smooth_group)
+{
+	for (SmoothGroupVert& this_vert : smooth_verts) {
+		if (smooth_group & this_vert.smooth_group) {
+			return this_vert.new_vert;
+		}
+	}
+
+	// Use default vert if no smooth groups match
+	return vert_index;
+}
+
+void MultiVertex::add_smooth_vert(DWORD smooth_group, DWORD vertex)
+{
+	if (smooth_group == 0) {
+		return;
+	}
+
+	for (SmoothGroupVert& this_vert : smooth_verts) {
+		if (smooth_group & this_vert.smooth_group) {
+			this_vert.smooth_group |= smooth_group;
+			return;
+		}
+	}
+
+	smooth_verts.push_back(SmoothGroupVert{ smooth_group, vertex });
+}
+
+void MultiVertex::collapse_list()
+{
+	for (list_iter iter = smooth_verts.begin(); iter != smooth_verts.end(); ++iter) {
+		list_iter inner_iter = smooth_verts.begin();
+		while (inner_iter != smooth_verts.end()) {
+			if (inner_iter == iter) {
+				++inner_iter;
+				continue;
+			}
+
+			if (iter->smooth_group & inner_iter->smooth_group) {
+				iter->smooth_group |= inner_iter->smooth_group;
+				smooth_verts.erase(inner_iter++);
+			}
+			else {
+				++inner_iter;
+			}
+		}
+	}
+}
+
+SmoothGroupSplit ref_split_smoothing_groups(
+	const size_t num_input_verts,
+	const size_t num_faces,
+	const int* const face_verts,
+	const std::uint32_t* const face_smooth_groups)
+{
+	SmoothGroupSplit result;
+
+	std::vector<MultiVertex> multi_verts;
+	multi_verts.resize(num_input_verts, MultiVertex(0));
+	for (size_t i = 0; i < multi_verts.size(); ++i) {
+		multi_verts[i] = MultiVertex(static_cast<unsigned int>(i));
+	}
+
+	for (size_t i = 0; i < num_faces; ++i) {
+		for (size_t j = 0; j < 3; ++j) {
+			const int vert = face_verts[i * 3 + j];
+			multi_verts[vert].add_smooth_vert(face_smooth_groups[i], vert);
+		}
+	}
+
+	size_t total_verts = num_input_verts;
+	for (MultiVertex& multi_vert : multi_verts) {
+		multi_vert.collapse_list();
+
+		MultiVertex::list_iter normal_iter = multi_vert.smooth_verts.begin();
+		if (normal_iter == multi_vert.smooth_verts.end()) {
+			continue;
+		}
+		++normal_iter;
+		while (normal_iter != multi_vert.smooth_verts.end()) {
+			normal_iter->new_vert = static_cast<DWORD>(total_verts);
+			++total_verts;
+			++normal_iter;
+		}
+	}
+
+	result.total_verts = total_verts;
+	result.duplicated_from.resize(total_verts - num_input_verts);
+	for (MultiVertex& multi_vert : multi_verts) {
+		if (multi_vert.smooth_verts.size() < 2) {
+			continue;
+		}
+		for (SmoothGroupVert& smooth_vert : multi_vert.smooth_verts) {
+			if (smooth_vert.new_vert == multi_vert.vert_index) {
+				continue;
+			}
+			result.duplicated_from[smooth_vert.new_vert - num_input_verts] = multi_vert.vert_index;
+		}
+	}
+
+	result.corner_verts.resize(num_faces * 3);
+	for (size_t i = 0; i < num_faces; ++i) {
+		for (size_t j = 0; j < 3; ++j) {
+			result.corner_verts[i * 3 + j] = multi_verts[face_verts[i * 3 + j]].get_vert_index(face_smooth_groups[i]);
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,40 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#pragma once
+
+/**
+ * @file
+ * @brief Defines the list-based smoothing group splitter that split_smoothing_groups replaced.
+ *
+ * Kept only as a baseline for benchmarks and to check that both produce the same output.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "util_smooth_groups.h"
+
+/**
+ * @brief Splits vertices with the MultiVertex algorithm formerly used by get_mesh_geometry(Mesh*, ...).
+ */
+SmoothGroupSplit ref_split_smoothing_groups(
+	size_t num_input_verts,
+	size_t num_faces,
+	const int* face_verts,
+	const std::uint32_t* face_smooth_groups
+);
@@ -0,0 +1,52 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+/**
+ * @file
+ * @brief Provides the RenderPassInfo constructors needed by the benchmarks.
+ *
+ * util_pass.cpp depends on the render element classes and through them on the Max SDK, so it can't be built here.
+ * These match the definitions in util_pass.cpp for passes that are not backed by a render element.
+ */
+
+#include "util_pass.h"
+
+#include <array>
+#include <cstdio>
+
+RenderPassInfo::RenderPassInfo() :
+	type{ RenderPassType::COMBINED },
+	ccl_type{ ccl::PassType::PASS_COMBINED },
+	channels{ 4 },
+	name{ "Combined" },
+	render_element{ nullptr }
+{
+
+}
+
+RenderPassInfo::RenderPassInfo(RenderPassType type, ccl::PassType ccl_type, int channels, std::string name, size_t suffix) :
+	type{ type },
+	ccl_type{ ccl_type },
+	channels{ channels },
+	name{ name },
+	render_element{ nullptr }
+{
+	std::array<char, 48> buffer;
+	buffer.fill('\0');
+	snprintf(buffer.data(), buffer.size(), "%s%02d", name.data(), static_cast<int>(suffix));
+	this->name = std::string{ buffer.data() };
+}
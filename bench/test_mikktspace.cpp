@@ -0,0 +1,160 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+/**
+ * @file
+ * @brief Regression test checking that genTangSpaceParallel produces output bitwise identical to genTangSpace.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
+
+#include "bench_mesh.h"
+
+// Uniform random attributes, faces reference vertices in any order so vertices are shared arbitrarily
+static BenchMesh make_random_mesh(const size_t num_verts, const size_t num_faces, const int verts_per_face, const unsigned int seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	std::uniform_int_distribution<int> vert_dist(0, static_cast<int>(num_verts) - 1);
+
+	BenchMesh result;
+	result.verts_per_face = verts_per_face;
+	for (size_t i = 0; i < num_verts * 3; i++) {
+		result.positions.push_back(dist(rng));
+	}
+	for (size_t i = 0; i < num_faces * verts_per_face; i++) {
+		result.face_verts.push_back(vert_dist(rng));
+		result.corner_normals.push_back(dist(rng));
+		result.corner_normals.push_back(dist(rng));
+		result.corner_normals.push_back(dist(rng));
+		result.corner_uvs.push_back(dist(rng));
+		result.corner_uvs.push_back(dist(rng));
+	}
+	return result;
+}
+
+// Grid where some triangles have zero area, collapsed UVs or repeated corners
+static BenchMesh make_degenerate_mesh(const int verts_per_face)
+{
+	BenchMesh result = make_grid_mesh(64, 64, verts_per_face == 4);
+	const size_t corners = result.face_verts.size();
+	for (size_t corner = 0; corner < corners; corner += verts_per_face) {
+		const size_t face = corner / verts_per_face;
+		switch (face % 7) {
+		case 0:
+			// Repeated vertex index, zero area in position and UV
+			result.face_verts[corner + 1] = result.face_verts[corner];
+			break;
+		case 1:
+			// All UVs identical
+			for (int i = 0; i < verts_per_face; i++) {
+				result.corner_uvs[(corner + i) * 2 + 0] = 0.5f;
+				result.corner_uvs[(corner + i) * 2 + 1] = 0.5f;
+			}
+			break;
+		case 2:
+			// Zero length normal
+			result.corner_normals[corner * 3 + 0] = 0.0f;
+			result.corner_normals[corner * 3 + 1] = 0.0f;
+			result.corner_normals[corner * 3 + 2] = 0.0f;
+			break;
+		case 3:
+			// Collinear corners
+			result.face_verts[corner + 2] = result.face_verts[corner + 1];
+			result.face_verts[corner + 1] = result.face_verts[corner];
+			break;
+		default:
+			break;
+		}
+	}
+	return result;
+}
+
+// Every vertex is duplicated so welding has to merge them by position, and every face appears twice
+static BenchMesh make_welded_mesh(const int verts_per_face)
+{
+	const BenchMesh grid = make_grid_mesh(64, 64, verts_per_face == 4);
+	const int num_grid_verts = static_cast<int>(grid.num_verts());
+
+	BenchMesh result = grid;
+	result.positions.insert(result.positions.end(), grid.positions.begin(), grid.positions.end());
+	for (size_t i = 0; i < grid.face_verts.size(); i++) {
+		if ((i / verts_per_face) % 2 == 1) {
+			result.face_verts[i] += num_grid_verts;
+		}
+	}
+	result.face_verts.insert(result.face_verts.end(), grid.face_verts.begin(), grid.face_verts.end());
+	result.corner_normals.insert(result.corner_normals.end(), grid.corner_normals.begin(), grid.corner_normals.end());
+	result.corner_uvs.insert(result.corner_uvs.end(), grid.corner_uvs.begin(), grid.corner_uvs.end());
+	return result;
+}
+
+static bool check_mesh(const std::string& name, BenchMesh mesh, const float angular_threshold)
+{
+	const bool serial_ok = generate_tangents(mesh, false, angular_threshold);
+	const std::vector<float> serial_tangents = mesh.corner_tangents;
+
+	tbb::task_arena arena(8);
+	bool parallel_ok = false;
+	arena.execute([&]() {
+		parallel_ok = generate_tangents(mesh, true, angular_threshold);
+	});
+
+	if (serial_ok != parallel_ok) {
+		std::printf("FAILED %s: serial and parallel return values differ\n", name.c_str());
+		return false;
+	}
+	if (std::memcmp(serial_tangents.data(), mesh.corner_tangents.data(), serial_tangents.size() * sizeof(float)) != 0) {
+		std::printf("FAILED %s: parallel tangents differ from serial tangents\n", name.c_str());
+		return false;
+	}
+	std::printf("passed %s\n", name.c_str());
+	return true;
+}
+
+int main()
+{
+	// Allow more worker threads than cores so the parallel paths really run concurrently on small machines
+	tbb::global_control thread_limit(tbb::global_control::max_allowed_parallelism, 8);
+
+	bool success = true;
+
+	for (const int verts_per_face : { 3, 4 }) {
+		const std::string suffix = verts_per_face == 4 ? " quads" : " tris";
+		for (const float threshold : { 180.0f, 45.0f }) {
+			const std::string name_suffix = suffix + " threshold " + std::to_string(static_cast<int>(threshold));
+
+			success = check_mesh("grid" + name_suffix, make_grid_mesh(200, 150, verts_per_face == 4), threshold) && success;
+			success = check_mesh("degenerate" + name_suffix, make_degenerate_mesh(verts_per_face), threshold) && success;
+			success = check_mesh("welded" + name_suffix, make_welded_mesh(verts_per_face), threshold) && success;
+			for (unsigned int seed = 1; seed <= 4; seed++) {
+				const BenchMesh mesh = make_random_mesh(500 * seed, 2000 * seed, verts_per_face, seed);
+				success = check_mesh("random " + std::to_string(seed) + name_suffix, mesh, threshold) && success;
+			}
+		}
+	}
+
+	return success ? 0 : 1;
+}
@@ -20,6 +20,7 @@
 
 #include "cache_baked_texmap.h"
 
+#include <algorithm>
 #include <queue>
 
 #include <boost/optional.hpp>
@@ -199,7 +200,7 @@ ccl::ImageTextureNode* BakedTexmapCache::get_node_from_texmap(Texmap* const texm
 	return result;
 }
 
-ccl::EnvironmentTextureNode* BakedTexmapCache::get_env_node_from_texmap(Texmap* const texmap, ccl::Scene* const scene)
+ccl::EnvironmentTextureNode* BakedTexmapCache::get_env_node_from_texmap(Texmap* const texmap, ccl::Scene* const scene, Int2* const sampled_resolution)
 {
 	*logger << "get_env_node_from_texmap called..." << LogCtl::WRITE_LINE;
 
@@ -209,13 +210,16 @@ ccl::EnvironmentTextureNode* BakedTexmapCache::get_env_node_from_texmap(Texmap*
 	if (texmap->ClassID() == CYCLES_TEXMAP_ENVIRONMENT_CLASS) {
 		EnvironmentTexmap* env_map = dynamic_cast<EnvironmentTexmap*>(texmap);
 		if (env_map != nullptr && env_map->GetBGMap() != nullptr) {
-			return get_env_node_from_texmap(env_map->GetBGMap(), scene);
+			return get_env_node_from_texmap(env_map->GetBGMap(), scene, sampled_resolution);
 		}
 	}
 
 	ccl::EnvironmentTextureNode* const result = new ccl::EnvironmentTextureNode();
 
 	const SampledImage sampled_image = make_sampled_image(texmap);
+	if (sampled_resolution != nullptr) {
+		*sampled_resolution = Int2(static_cast<int>(sampled_image.width), static_cast<int>(sampled_image.height));
+	}
 	result->set_filename(ccl::ustring{ sampled_image.filename });
 	result->handle = scene->image_manager->add_image(new CyclesPluginImageLoader(sampled_image), result->image_params());
 
@@ -290,6 +294,16 @@ void BakedTexmapCache::queue_dirty_texmaps()
 		sampled_images.erase(desc);
 	}
 
+	// Forget probe results that point at released images, the texmap may not exist anymore
+	for (auto iter = probed_descriptors.begin(); iter != probed_descriptors.end();) {
+		if (sampled_images.count(iter->second) == 0) {
+			iter = probed_descriptors.erase(iter);
+		}
+		else {
+			++iter;
+		}
+	}
+
 	for (std::pair<SampledTexmapDescriptor, SampledImage> this_pair : sampled_images) {
 		if (dirty_texmaps.count(this_pair.first.texmap) == 1) {
 			prepare_texmap(this_pair.first.texmap, frame_time);
@@ -340,6 +354,40 @@ void BakedTexmapCache::set_texmap_times(std::map<Texmap*, std::chrono::steady_cl
 	texmap_update_times = times_in;
 }
 
+void BakedTexmapCache::set_texmap_screen_sizes(const std::map<Texmap*, int>& sizes_in)
+{
+	texmap_screen_sizes = sizes_in;
+}
+
+bool BakedTexmapCache::get_sampled_image(const std::string& filename, SampledImage& sampled_image) const
+{
+	for (const auto& this_pair : sampled_images) {
+		if (this_pair.second.filename == filename) {
+			sampled_image = this_pair.second;
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t BakedTexmapCache::get_baked_memory_usage() const
+{
+	const size_t TEXTURE_CHANNELS = 4;
+
+	size_t result = 0;
+	for (const auto& this_pair : sampled_images) {
+		const SampledImage& this_image = this_pair.second;
+		const size_t pixel_count = this_image.width * this_image.height;
+		if (this_image.float_pixels) {
+			result += pixel_count * TEXTURE_CHANNELS * sizeof(float);
+		}
+		if (this_image.char_pixels) {
+			result += pixel_count * TEXTURE_CHANNELS * sizeof(unsigned char);
+		}
+	}
+	return result;
+}
+
 void BakedTexmapCache::bake_all_texmaps()
 {
 	*logger << "bake_all_texmaps called..." << LogCtl::WRITE_LINE;
@@ -409,6 +457,18 @@ SampledImage BakedTexmapCache::make_sampled_image(Texmap* texmap, bool use_argum
 	*logger << "Sampling resolution: " << sampling.width << ' ' << sampling.height << LogCtl::WRITE_LINE;
 	*logger << "use_float: " << sampling.use_float << LogCtl::WRITE_LINE;
 
+	// If the surfaces using this texmap are small on screen, shrink the bake to match
+	// Explicit resolutions from arguments or a bitmap filter are always respected
+	const auto screen_size = texmap_screen_sizes.find(texmap);
+	if (use_arguments == false && texmap->ClassID() != CYCLES_TEXMAP_FILTER_CLASS && screen_size != texmap_screen_sizes.end()) {
+		const int max_dimension = std::max(sampling.width, sampling.height);
+		if (screen_size->second < max_dimension) {
+			sampling.width = std::max(1, (sampling.width * screen_size->second) / max_dimension);
+			sampling.height = std::max(1, (sampling.height * screen_size->second) / max_dimension);
+			*logger << "Screen size resolution: " << sampling.width << ' ' << sampling.height << LogCtl::WRITE_LINE;
+		}
+	}
+
 	// Special case for mtl edit renders, cap to 512x512
 	if (session_context.GetRenderSettings().GetIsMEditRender()) {
 		if (sampling.width > 512) {
@@ -441,6 +501,24 @@ SampledImage BakedTexmapCache::make_sampled_image(Texmap* texmap, bool use_argum
 		desc.use_radial_sampling = true;
 	}
 
+	// Maps that resolve to a flat color only need a single pixel, probe the map before allocating a full image
+	// The result is reused until the texmap changes or its image is released
+	const auto probed_desc = probed_descriptors.find(desc);
+	const bool texmap_changed = texmap_update_times.count(desc.texmap) == 1 && texmap_update_times[desc.texmap] >= last_bake_begin_time;
+	if (probed_desc != probed_descriptors.end() && texmap_changed == false) {
+		desc = probed_desc->second;
+	}
+	else if (desc.width > 1 || desc.height > 1) {
+		const SampledTexmapDescriptor requested_desc = desc;
+		prepare_texmap(render_texmap, frame_time);
+		if (is_texmap_constant(render_texmap, desc.width, desc.height, desc.use_radial_sampling, frame_time)) {
+			*logger << "Texmap is constant, sampling as 1x1" << LogCtl::WRITE_LINE;
+			desc.width = 1;
+			desc.height = 1;
+		}
+		probed_descriptors[requested_desc] = desc;
+	}
+
 	if (sampled_images.count(desc) == 1) {
 		this_frame_sampled_maps.insert(desc);
 		if (texmap_update_times[desc.texmap] >= last_bake_begin_time) {
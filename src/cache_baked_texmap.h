@@ -27,6 +27,7 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
 
 #include <maxtypes.h>
 
@@ -77,7 +78,8 @@ public:
 
 	ccl::ImageTextureNode* get_node_from_texmap(Texmap* texmap, ccl::Scene* scene, int width, int height, bool sample_as_float);
 	ccl::ImageTextureNode* get_node_from_texmap(Texmap* texmap, ccl::Scene* scene);
-	ccl::EnvironmentTextureNode* get_env_node_from_texmap(Texmap* texmap, ccl::Scene* scene);
+	// If sampled_resolution is not null, it is set to the resolution the texmap is baked at
+	ccl::EnvironmentTextureNode* get_env_node_from_texmap(Texmap* texmap, ccl::Scene* scene, Int2* sampled_resolution = nullptr);
 
 	// Functions to handle backplate texture for compositing
 	void set_backplate_texmap(Texmap* texmap);
@@ -91,6 +93,15 @@ public:
 
 	void set_texmap_times(std::map<Texmap*, std::chrono::steady_clock::time_point>& times_in);
 
+	// Sets the largest on-screen size in pixels of the surfaces using each texmap, used to cap default bake resolution
+	void set_texmap_screen_sizes(const std::map<Texmap*, int>& sizes_in);
+
+	// Total size in bytes of the pixel data of every baked texmap currently held by the cache
+	size_t get_baked_memory_usage() const;
+
+	// Finds the baked image that was given the specified filename, returns false if there is none
+	bool get_sampled_image(const std::string& filename, SampledImage& sampled_image) const;
+
 	// To be removed
 	void bake_all_texmaps();
 
@@ -117,6 +128,12 @@ private:
 	std::chrono::steady_clock::time_point last_bake_begin_time;
 	std::map<Texmap*, std::chrono::steady_clock::time_point> texmap_update_times;
 
+	std::map<Texmap*, int> texmap_screen_sizes;
+
+	// Maps each requested descriptor to the descriptor actually baked, which is 1x1 for constant texmaps
+	// This lets repeated requests skip the constant texmap probe
+	std::map<SampledTexmapDescriptor, SampledTexmapDescriptor> probed_descriptors;
+
 	SampledImage make_sampled_image(Texmap* texmap, bool use_arguments = false, int width_in = 512, int height_in = 512, bool sample_as_float = false);
 
 	void prepare_texmap(Texmap* texmap, TimeValue t);
@@ -0,0 +1,61 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#include "cache_shader_graph.h"
+
+#include <functional>
+
+#include <boost/optional.hpp>
+
+#include <shader_graph/graph.h>
+
+// Upper bound on the number of parsed graphs kept alive between renders
+static constexpr size_t MAX_CACHED_GRAPHS = 1024;
+
+ParsedShaderGraphCache global_shader_graph_cache;
+
+size_t hash_encoded_graph(const std::string& encoded_graph)
+{
+	return std::hash<std::string>{}(encoded_graph);
+}
+
+std::shared_ptr<const csg::Graph> ParsedShaderGraphCache::get_graph(const std::string& encoded_graph, const size_t graph_hash)
+{
+	std::lock_guard<std::mutex> lock(cache_mutex);
+
+	const auto existing_iter = cached_graphs.find(graph_hash);
+	if (existing_iter != cached_graphs.end() && existing_iter->second.encoded_graph == encoded_graph) {
+		return existing_iter->second.graph;
+	}
+
+	std::shared_ptr<const csg::Graph> result;
+	const boost::optional<csg::Graph> opt_graph{ csg::Graph::from(encoded_graph) };
+	if (opt_graph) {
+		result = std::make_shared<const csg::Graph>(*opt_graph);
+	}
+
+	if (cached_graphs.size() >= MAX_CACHED_GRAPHS) {
+		cached_graphs.clear();
+	}
+
+	// On a hash collision the newer graph replaces the old one, the string comparison above keeps this correct
+	CachedGraph& entry = cached_graphs[graph_hash];
+	entry.encoded_graph = encoded_graph;
+	entry.graph = result;
+
+	return result;
+}
@@ -0,0 +1,62 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#pragma once
+
+/**
+ * @file
+ * @brief Defines ParsedShaderGraphCache.
+ */
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace csg {
+	class Graph;
+}
+
+/**
+ * @brief Hash function used to identify encoded node graphs.
+ */
+size_t hash_encoded_graph(const std::string& encoded_graph);
+
+/**
+ * @brief Class responsible for storing parsed csg::Graph objects keyed by the hash of their serialized form.
+ *
+ * A single instance is shared by all render sessions so that ActiveShade rebuilds and consecutive frames do not need
+ * to parse unchanged graphs again.
+ */
+class ParsedShaderGraphCache {
+public:
+	// Returns a parsed graph, or an empty pointer if encoded_graph is not a valid graph
+	std::shared_ptr<const csg::Graph> get_graph(const std::string& encoded_graph, size_t graph_hash);
+
+private:
+	class CachedGraph {
+	public:
+		std::string encoded_graph;
+		std::shared_ptr<const csg::Graph> graph;
+	};
+
+	std::mutex cache_mutex;
+	std::map<size_t, CachedGraph> cached_graphs;
+};
+
+extern ParsedShaderGraphCache global_shader_graph_cache;
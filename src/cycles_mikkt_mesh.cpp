@@ -17,27 +17,32 @@
  
 #include "cycles_mikkt_mesh.h"
 
+#include <vector>
+
 #include <render/mesh.h>
 
 #include "extern_mikktspace.h"
 #include "rend_logger.h"
 
+/**
+ * @brief Per-corner mesh data gathered once before evaluation.
+ *
+ * MikkTSpace reads each corner many times while welding vertices and building groups, storing everything in flat
+ * arrays indexed by 3 * face + vert keeps those reads cheap and safe to perform from multiple threads.
+ */
 struct CyclesMeshTangentContext {
-	ccl::Mesh* mesh;
-	ccl::float3* vertex_normals;
-	ccl::float3* tex_coords;
+	int num_faces;
+	std::vector<ccl::float3> positions;
+	std::vector<ccl::float3> normals;
+	std::vector<ccl::float2> tex_coords;
 	ccl::float3* uv_tangents;
 	float* uv_tangent_signs;
 };
 
 static int get_num_faces(const SMikkTSpaceContext* const pContext)
 {
-	CyclesMeshTangentContext* const context = static_cast<CyclesMeshTangentContext*>(pContext->m_pUserData);
-	ccl::Mesh* const mesh = context->mesh;
-
-	const int num_faces = static_cast<int>(mesh->num_triangles());
-
-	return num_faces;
+	const CyclesMeshTangentContext* const context = static_cast<const CyclesMeshTangentContext*>(pContext->m_pUserData);
+	return context->num_faces;
 }
 
 static int get_num_vertices_of_face(const SMikkTSpaceContext* const /*pContext*/, const int /*iFace*/)
@@ -48,11 +53,8 @@ static int get_num_vertices_of_face(const SMikkTSpaceContext* const /*pContext*/
 
 static void get_position(const SMikkTSpaceContext* const pContext, float fvPosOut[], const int iFace, const int iVert)
 {
-	CyclesMeshTangentContext* const context = static_cast<CyclesMeshTangentContext*>(pContext->m_pUserData);
-	ccl::Mesh* const mesh = context->mesh;
-
-	const ccl::Mesh::Triangle triangle = mesh->get_triangle(iFace);
-	const ccl::float3 position = mesh->get_verts()[triangle.v[iVert]];
+	const CyclesMeshTangentContext* const context = static_cast<const CyclesMeshTangentContext*>(pContext->m_pUserData);
+	const ccl::float3& position = context->positions[3 * iFace + iVert];
 	
 	fvPosOut[0] = position.x;
 	fvPosOut[1] = position.y;
@@ -61,12 +63,8 @@ static void get_position(const SMikkTSpaceContext* const pContext, float fvPosOu
 
 static void get_normal(const SMikkTSpaceContext* pContext, float fvNormOut[], const int iFace, const int iVert)
 {
-	CyclesMeshTangentContext* const context = static_cast<CyclesMeshTangentContext*>(pContext->m_pUserData);
-	ccl::Mesh* const mesh = context->mesh;
-	ccl::float3* const vertex_normals = context->vertex_normals;
-
-	const ccl::Mesh::Triangle triangle = mesh->get_triangle(iFace);
-	const ccl::float3 normal = vertex_normals[triangle.v[iVert]];
+	const CyclesMeshTangentContext* const context = static_cast<const CyclesMeshTangentContext*>(pContext->m_pUserData);
+	const ccl::float3& normal = context->normals[3 * iFace + iVert];
 	
 	fvNormOut[0] = normal.x;
 	fvNormOut[1] = normal.y;
@@ -75,10 +73,8 @@ static void get_normal(const SMikkTSpaceContext* pContext, float fvNormOut[], co
 
 static void get_tex_coord(const SMikkTSpaceContext* const pContext, float fvTexcOut[], const int iFace, const int iVert)
 {
-	CyclesMeshTangentContext* const context = static_cast<CyclesMeshTangentContext*>(pContext->m_pUserData);
-	ccl::float3* const tex_coords = context->tex_coords;
-
-	const ccl::float3 tex_coord = tex_coords[3 * iFace + iVert];
+	const CyclesMeshTangentContext* const context = static_cast<const CyclesMeshTangentContext*>(pContext->m_pUserData);
+	const ccl::float2& tex_coord = context->tex_coords[3 * iFace + iVert];
 
 	fvTexcOut[0] = tex_coord.x;
 	fvTexcOut[1] = tex_coord.y;
@@ -136,11 +132,24 @@ void add_ccl_mesh_tangents(ccl::Mesh* const mesh)
 
 	mikkt_space_interface.m_setTSpace = nullptr;
 
+	const ccl::array<ccl::float3>& verts = mesh->get_verts();
+	const ccl::array<int>& triangles = mesh->get_triangles();
+	const ccl::float3* const vertex_normals = mesh->attributes.find(ccl::AttributeStandard::ATTR_STD_VERTEX_NORMAL)->data_float3();
+	const ccl::float2* const uvs = mesh->attributes.find(ccl::AttributeStandard::ATTR_STD_UV)->data_float2();
+
 	CyclesMeshTangentContext mesh_context;
-	mesh_context.mesh = mesh;
-	mesh_context.vertex_normals = mesh->attributes.find(ccl::AttributeStandard::ATTR_STD_VERTEX_NORMAL)->data_float3();
-	mesh_context.tex_coords = mesh->attributes.find(ccl::AttributeStandard::ATTR_STD_UV)->data_float3();
-	
+	mesh_context.num_faces = static_cast<int>(mesh->num_triangles());
+
+	const size_t num_corners = 3 * static_cast<size_t>(mesh_context.num_faces);
+	mesh_context.positions.resize(num_corners);
+	mesh_context.normals.resize(num_corners);
+	mesh_context.tex_coords.assign(uvs, uvs + num_corners);
+	for (size_t i = 0; i < num_corners; i++) {
+		const int vert_index = triangles[i];
+		mesh_context.positions[i] = verts[vert_index];
+		mesh_context.normals[i] = vertex_normals[vert_index];
+	}
+
 	ccl::Attribute* const attribute_uv_tangent = mesh->attributes.add(ccl::AttributeStandard::ATTR_STD_UV_TANGENT);
 	mesh_context.uv_tangents = attribute_uv_tangent->data_float3();
 
@@ -153,7 +162,7 @@ void add_ccl_mesh_tangents(ccl::Mesh* const mesh)
 	
 	*logger << "Context setup complete, evaluating..." << LogCtl::WRITE_LINE;
 
-	genTangSpaceDefault(&mikkt_space_context);
+	genTangSpaceDefaultParallel(&mikkt_space_context);
 
 	*logger << "Tangent space calculation complete" << LogCtl::WRITE_LINE;
 }
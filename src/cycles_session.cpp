@@ -17,6 +17,8 @@
  
 #include "cycles_session.h"
 
+#include <algorithm>
+
 #include <render/background.h>
 #include <render/scene.h>
 
@@ -241,7 +243,8 @@ void CyclesSession::start(const int render_index)
 	}
 
 	// If a compositing backplate is set, force transparent sky on
-	if (backplate_bitmap) {
+	// Only tag the background when it actually changes so later stereo eyes do not trigger a background update
+	if (backplate_bitmap && scene->background->get_transparent() == false) {
 		scene->background->set_transparent(true);
 		scene->background->tag_update(scene);
 	}
@@ -262,16 +265,7 @@ void CyclesSession::copy_accum_buffer(MaxSDK::RenderingAPI::IRenderSessionContex
 			buffer_tone_operator = current_tone_operator;
 		}
 	}
-	IntRect adjusted_region = rend_params.region;
-	if (accumulation_buffer_type == AccumulationBufferType::TOP_BOTTOM && render_index % 2 == 1) {
-		const Int2 adjustment = Int2(0, resolutions.render_res().y());
-		adjusted_region = adjusted_region.move(adjustment);
-	}
-	else if (accumulation_buffer_type == AccumulationBufferType::LEFT_RIGHT && render_index % 2 == 1) {
-		const Int2 adjustment = Int2(resolutions.render_res().x(), 0);
-		adjusted_region = adjusted_region.move(adjustment);
-	}
-	AccumulationBufferReader buffer_reader(accumulation_buffer.get(), buffer_tone_operator, adjusted_region);
+	AccumulationBufferReader buffer_reader(accumulation_buffer.get(), buffer_tone_operator, get_output_region());
 	if (rend_params.use_transparent_sky == false) {
 		// We only want to comp in a backplate if the sky is visible
 		buffer_reader.set_backplate(backplate_bitmap);
@@ -334,6 +328,21 @@ void CyclesSession::write_render_tile(ccl::RenderTile& rtile)
 	copy_rtile_to_accum(rtile, false);
 }
 
+IntRect CyclesSession::get_output_region() const
+{
+	// For side-by-side stereo the region of the current eye is offset into its half of the output image
+	IntRect adjusted_region = rend_params.region;
+	if (accumulation_buffer_type == AccumulationBufferType::TOP_BOTTOM && render_index % 2 == 1) {
+		const Int2 adjustment = Int2(0, resolutions.render_res().y());
+		adjusted_region = adjusted_region.move(adjustment);
+	}
+	else if (accumulation_buffer_type == AccumulationBufferType::LEFT_RIGHT && render_index % 2 == 1) {
+		const Int2 adjustment = Int2(resolutions.render_res().x(), 0);
+		adjusted_region = adjusted_region.move(adjustment);
+	}
+	return adjusted_region;
+}
+
 void CyclesSession::init_accumulation_buffer()
 {
 	const int width{ resolutions.output_res().x() };
@@ -367,6 +376,20 @@ void CyclesSession::copy_rtile_to_accum(ccl::RenderTile& rtile, const bool highl
 	constexpr size_t MAX_CHANNELS = 4;
 	std::vector<float> pixels(MAX_CHANNELS * params.width * params.height);
 
+	// Early passes of a session with a start resolution are rendered at 1/divider size, these are scaled back up with
+	// nearest filtering so the accumulation buffer always holds a full size image
+	const size_t divider = static_cast<size_t>(std::max(tile_manager.state.resolution_divider, 1));
+	const size_t dest_x = rtile.x * divider;
+	const size_t dest_y = rtile.y * divider;
+	size_t dest_width = tile_width;
+	size_t dest_height = tile_height;
+	std::vector<float> scaled_pixels;
+	if (divider > 1) {
+		dest_width = std::min(tile_width * divider, static_cast<size_t>(cached_buffer_params.width) - dest_x);
+		dest_height = std::min(tile_height * divider, static_cast<size_t>(cached_buffer_params.height) - dest_y);
+		scaled_pixels.resize(MAX_CHANNELS * dest_width * dest_height);
+	}
+
 	// Loop through all available passes and copy from tile to accumulation buffer
 	for (const RenderPassInfo& this_pass_info : render_pass_info_vec) {
 		int sample = rtile.sample;
@@ -420,13 +443,29 @@ void CyclesSession::copy_rtile_to_accum(ccl::RenderTile& rtile, const bool highl
 			}
 		}
 
+		float* tile_pixels = pixels.data();
+		if (divider > 1) {
+			thread_log(L"Scaling up preview tile");
+			const size_t channels = static_cast<size_t>(this_pass_info.channels);
+			for (size_t y = 0; y < dest_height; y++) {
+				for (size_t x = 0; x < dest_width; x++) {
+					const size_t src_index = ((y / divider) * tile_width + (x / divider)) * channels;
+					const size_t dest_index = (y * dest_width + x) * channels;
+					for (size_t c = 0; c < channels; c++) {
+						scaled_pixels[dest_index + c] = pixels[src_index + c];
+					}
+				}
+			}
+			tile_pixels = scaled_pixels.data();
+		}
+
 		if (this_pass_info.type == RenderPassType::COMBINED) {
 			thread_log(L"copying as combined");
 			copy_combined_tile_pixels_to_accum(
-				pixels.data(), accumulation_buffer->get_pass_buffer("Combined"),
+				tile_pixels, accumulation_buffer->get_pass_buffer("Combined"),
 				resolutions,
-				rtile.x, rtile.y,
-				tile_width, tile_height,
+				dest_x, dest_y,
+				dest_width, dest_height,
 				accumulation_buffer_type,
 				render_index,
 				rend_params.region
@@ -436,10 +475,10 @@ void CyclesSession::copy_rtile_to_accum(ccl::RenderTile& rtile, const bool highl
 		else {
 			thread_log(L"copying as other");
 			copy_data_tile_pixels_to_accum(
-				pixels.data(), accumulation_buffer->get_pass_buffer(this_pass_info.name),
+				tile_pixels, accumulation_buffer->get_pass_buffer(this_pass_info.name),
 				resolutions,
-				rtile.x, rtile.y,
-				tile_width, tile_height,
+				dest_x, dest_y,
+				dest_width, dest_height,
 				static_cast<size_t>(this_pass_info.channels),
 				accumulation_buffer_type,
 				render_index,
@@ -475,7 +514,7 @@ void CyclesSession::copy_passes_from_accum()
 		BMM_Color_fl* const temp_line_buffer = new BMM_Color_fl[resolutions.output_res().x()];
 
 		// Iterate through and copy each row to temp buffer, then to re bitmap
-		const IntRect region = rend_params.region;
+		const IntRect region = get_output_region();
 		for (size_t i = 0; i < resolutions.output_res().y(); i++) {
 			const int output_y = (resolutions.output_res().y() - 1) - static_cast<int>(i);
 			if (output_y < region.begin().y() || output_y >= region.end().y()) {
@@ -96,6 +96,8 @@ private:
 
 	void init_accumulation_buffer();
 
+	IntRect get_output_region() const;
+
 	void copy_rtile_to_accum(ccl::RenderTile& rtile, bool highlight_this_tile);
 	void copy_passes_from_accum();
 
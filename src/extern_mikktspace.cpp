@@ -25,8 +25,18 @@
 #include <float.h>
 #include <stdlib.h>
 
+#include <atomic>
+
+#include <util/util_tbb.h>
+
 #include "extern_mikktspace.h"
 
+/*
+ * Altered for Cycles for Max: genTangSpaceParallel() evaluates the vertex welding, triangle derivatives and
+ * per-group tangent spaces on multiple threads. Each of these stages only writes to data owned by a single
+ * grid cell, triangle or group so the output is identical to that of genTangSpace().
+ */
+
 #define TFALSE		0
 #define TTRUE		1
 
@@ -161,12 +171,26 @@ typedef struct {
 } STSpace;
 
 static int GenerateInitialVerticesIndexList(STriInfo pTriInfos[], int piTriList_out[], const SMikkTSpaceContext * pContext, const int iNrTrianglesIn);
-static void GenerateSharedVerticesIndexList(int piTriList_in_and_out[], const SMikkTSpaceContext * pContext, const int iNrTrianglesIn);
-static void InitTriInfo(STriInfo pTriInfos[], const int piTriListIn[], const SMikkTSpaceContext * pContext, const int iNrTrianglesIn);
+static void GenerateSharedVerticesIndexList(int piTriList_in_and_out[], const SMikkTSpaceContext * pContext, const int iNrTrianglesIn, const tbool bParallel);
+static void InitTriInfo(STriInfo pTriInfos[], const int piTriListIn[], const SMikkTSpaceContext * pContext, const int iNrTrianglesIn, const tbool bParallel);
 static int Build4RuleGroups(STriInfo pTriInfos[], SGroup pGroups[], int piGroupTrianglesBuffer[], const int piTriListIn[], const int iNrTrianglesIn);
 static tbool GenerateTSpaces(STSpace psTspace[], const STriInfo pTriInfos[], const SGroup pGroups[],
                              const int iNrActiveGroups, const int piTriListIn[], const float fThresCos,
-                             const SMikkTSpaceContext * pContext);
+                             const SMikkTSpaceContext * pContext, const tbool bParallel);
+
+// calls func(iBegin, iEnd) for sub-ranges of [0, iCount), possibly from multiple threads
+template <typename Func>
+static void ForEachRange(const int iCount, const tbool bParallel, const Func & func)
+{
+	if (bParallel && iCount>1)
+	{
+		ccl::parallel_for(ccl::blocked_range<int>(0, iCount), [&func](const ccl::blocked_range<int> & range) {
+			func(range.begin(), range.end());
+		});
+	}
+	else if (iCount>0)
+		func(0, iCount);
+}
 
 static int MakeIndex(const int iFace, const int iVert)
 {
@@ -220,12 +244,29 @@ static void DegenPrologue(STriInfo pTriInfos[], int piTriList_out[], const int i
 static void DegenEpilogue(STSpace psTspace[], STriInfo pTriInfos[], int piTriListIn[], const SMikkTSpaceContext * pContext, const int iNrTrianglesIn, const int iTotTris);
 
 
+static tbool genTangSpaceInternal(const SMikkTSpaceContext * pContext, const float fAngularThreshold, const tbool bParallel);
+
 tbool genTangSpaceDefault(const SMikkTSpaceContext * pContext)
 {
 	return genTangSpace(pContext, 180.0f);
 }
 
 tbool genTangSpace(const SMikkTSpaceContext * pContext, const float fAngularThreshold)
+{
+	return genTangSpaceInternal(pContext, fAngularThreshold, TFALSE);
+}
+
+tbool genTangSpaceDefaultParallel(const SMikkTSpaceContext * pContext)
+{
+	return genTangSpaceParallel(pContext, 180.0f);
+}
+
+tbool genTangSpaceParallel(const SMikkTSpaceContext * pContext, const float fAngularThreshold)
+{
+	return genTangSpaceInternal(pContext, fAngularThreshold, TTRUE);
+}
+
+static tbool genTangSpaceInternal(const SMikkTSpaceContext * pContext, const float fAngularThreshold, const tbool bParallel)
 {
 	// count nr_triangles
 	int * piTriListIn = NULL, * piGroupTrianglesBuffer = NULL;
@@ -271,26 +312,29 @@ tbool genTangSpace(const SMikkTSpaceContext * pContext, const float fAngularThre
 
 	// make a welded index list of identical positions and attributes (pos, norm, texc)
 	//printf("gen welded index list begin\n");
-	GenerateSharedVerticesIndexList(piTriListIn, pContext, iNrTrianglesIn);
+	GenerateSharedVerticesIndexList(piTriListIn, pContext, iNrTrianglesIn, bParallel);
 	//printf("gen welded index list end\n");
 
 	// Mark all degenerate triangles
 	iTotTris = iNrTrianglesIn;
 	iDegenTriangles = 0;
-	for (t=0; t<iTotTris; t++)
-	{
-		const int i0 = piTriListIn[t*3+0];
-		const int i1 = piTriListIn[t*3+1];
-		const int i2 = piTriListIn[t*3+2];
-		const SVec3 p0 = GetPosition(pContext, i0);
-		const SVec3 p1 = GetPosition(pContext, i1);
-		const SVec3 p2 = GetPosition(pContext, i2);
-		if (veq(p0,p1) || veq(p0,p2) || veq(p1,p2))	// degenerate
+	ForEachRange(iTotTris, bParallel, [&](const int iBegin, const int iEnd) {
+		int t=0;
+		for (t=iBegin; t<iEnd; t++)
 		{
-			pTriInfos[t].iFlag |= MARK_DEGENERATE;
-			++iDegenTriangles;
+			const int i0 = piTriListIn[t*3+0];
+			const int i1 = piTriListIn[t*3+1];
+			const int i2 = piTriListIn[t*3+2];
+			const SVec3 p0 = GetPosition(pContext, i0);
+			const SVec3 p1 = GetPosition(pContext, i1);
+			const SVec3 p2 = GetPosition(pContext, i2);
+			if (veq(p0,p1) || veq(p0,p2) || veq(p1,p2))	// degenerate
+				pTriInfos[t].iFlag |= MARK_DEGENERATE;
 		}
-	}
+	});
+	for (t=0; t<iTotTris; t++)
+		if ((pTriInfos[t].iFlag&MARK_DEGENERATE)!=0)
+			++iDegenTriangles;
 	iNrTrianglesIn = iTotTris - iDegenTriangles;
 
 	// mark all triangle pairs that belong to a quad with only one
@@ -303,7 +347,7 @@ tbool genTangSpace(const SMikkTSpaceContext * pContext, const float fAngularThre
 	
 	// evaluate triangle level attributes and neighbor list
 	//printf("gen neighbors list begin\n");
-	InitTriInfo(pTriInfos, piTriListIn, pContext, iNrTrianglesIn);
+	InitTriInfo(pTriInfos, piTriListIn, pContext, iNrTrianglesIn, bParallel);
 	//printf("gen neighbors list end\n");
 	
 	// based on the 4 rules, identify groups based on connectivity
@@ -345,7 +389,10 @@ tbool genTangSpace(const SMikkTSpaceContext * pContext, const float fAngularThre
 	// based on fAngularThreshold. Finally a tangent space is made for
 	// every resulting subgroup
 	//printf("gen tspaces begin\n");
-	bRes = GenerateTSpaces(psTspace, pTriInfos, pGroups, iNrActiveGroups, piTriListIn, fThresCos, pContext);
+	// groups can only be evaluated concurrently when every tspace is written by a single group, quads
+	// share tspaces between their two triangles and average them in group order
+	bRes = GenerateTSpaces(psTspace, pTriInfos, pGroups, iNrActiveGroups, piTriListIn, fThresCos, pContext,
+	                       (bParallel && iNrTSPaces==iTotTris*3) ? TTRUE : TFALSE);
 	//printf("gen tspaces end\n");
 	
 	// clean up
@@ -444,13 +491,13 @@ static void MergeVertsFast(int piTriList_in_and_out[], STmpVert pTmpVert[], cons
 static void MergeVertsSlow(int piTriList_in_and_out[], const SMikkTSpaceContext * pContext, const int pTable[], const int iEntries);
 static void GenerateSharedVerticesIndexListSlow(int piTriList_in_and_out[], const SMikkTSpaceContext * pContext, const int iNrTrianglesIn);
 
-static void GenerateSharedVerticesIndexList(int piTriList_in_and_out[], const SMikkTSpaceContext * pContext, const int iNrTrianglesIn)
+static void GenerateSharedVerticesIndexList(int piTriList_in_and_out[], const SMikkTSpaceContext * pContext, const int iNrTrianglesIn, const tbool bParallel)
 {
 
 	// Generate bounding box
 	int * piHashTable=NULL, * piHashCount=NULL, * piHashOffsets=NULL, * piHashCount2=NULL;
 	STmpVert * pTmpVert = NULL;
-	int i=0, iChannel=0, k=0, e=0;
+	int i=0, iChannel=0, k=0;
 	int iMaxCount=0;
 	SVec3 vMin = GetPosition(pContext, 0), vMax = vMin, vDim;
 	float fMin, fMax;
@@ -539,31 +586,39 @@ static void GenerateSharedVerticesIndexList(int piTriList_in_and_out[], const SM
 	for (k=1; k<g_iCells; k++)
 		if (iMaxCount<piHashCount[k])
 			iMaxCount=piHashCount[k];
-	pTmpVert = (STmpVert *) malloc(sizeof(STmpVert)*iMaxCount);
+	// when running in parallel every cell gets its own section of pTmpVert
+	if (bParallel)
+		pTmpVert = (STmpVert *) malloc(sizeof(STmpVert)*iNrTrianglesIn*3);
+	else
+		pTmpVert = (STmpVert *) malloc(sizeof(STmpVert)*iMaxCount);
 	
 
-	// complete the merge
-	for (k=0; k<g_iCells; k++)
-	{
-		// extract table of cell k and amount of entries in it
-		int * pTable = &piHashTable[piHashOffsets[k]];
-		const int iEntries = piHashCount[k];
-		if (iEntries < 2) continue;
-
-		if (pTmpVert!=NULL)
+	// complete the merge, each cell only touches the vertices inserted into it
+	ForEachRange(g_iCells, bParallel, [&](const int iBegin, const int iEnd) {
+		int k=0, e=0;
+		for (k=iBegin; k<iEnd; k++)
 		{
-			for (e=0; e<iEntries; e++)
+			// extract table of cell k and amount of entries in it
+			int * pTable = &piHashTable[piHashOffsets[k]];
+			const int iEntries = piHashCount[k];
+			if (iEntries < 2) continue;
+
+			if (pTmpVert!=NULL)
 			{
-				int i = pTable[e];
-				const SVec3 vP = GetPosition(pContext, piTriList_in_and_out[i]);
-				pTmpVert[e].vert[0] = vP.x; pTmpVert[e].vert[1] = vP.y;
-				pTmpVert[e].vert[2] = vP.z; pTmpVert[e].index = i;
+				STmpVert * pCellTmpVert = bParallel ? &pTmpVert[piHashOffsets[k]] : pTmpVert;
+				for (e=0; e<iEntries; e++)
+				{
+					int i = pTable[e];
+					const SVec3 vP = GetPosition(pContext, piTriList_in_and_out[i]);
+					pCellTmpVert[e].vert[0] = vP.x; pCellTmpVert[e].vert[1] = vP.y;
+					pCellTmpVert[e].vert[2] = vP.z; pCellTmpVert[e].index = i;
+				}
+				MergeVertsFast(piTriList_in_and_out, pCellTmpVert, pContext, 0, iEntries-1);
 			}
-			MergeVertsFast(piTriList_in_and_out, pTmpVert, pContext, 0, iEntries-1);
+			else
+				MergeVertsSlow(piTriList_in_and_out, pContext, pTable, iEntries);
 		}
-		else
-			MergeVertsSlow(piTriList_in_and_out, pContext, pTable, iEntries);
-	}
+	});
 
 	if (pTmpVert!=NULL) { free(pTmpVert); }
 	free(piHashTable);
@@ -931,70 +986,74 @@ static float CalcTexArea(const SMikkTSpaceContext * pContext, const int indices[
 	return fSignedAreaSTx2<0 ? (-fSignedAreaSTx2) : fSignedAreaSTx2;
 }
 
-static void InitTriInfo(STriInfo pTriInfos[], const int piTriListIn[], const SMikkTSpaceContext * pContext, const int iNrTrianglesIn)
+static void InitTriInfo(STriInfo pTriInfos[], const int piTriListIn[], const SMikkTSpaceContext * pContext, const int iNrTrianglesIn, const tbool bParallel)
 {
-	int f=0, i=0, t=0;
+	int t=0;
 	// pTriInfos[f].iFlag is cleared in GenerateInitialVerticesIndexList() which is called before this function.
 
-	// generate neighbor info list
-	for (f=0; f<iNrTrianglesIn; f++)
-		for (i=0; i<3; i++)
-		{
-			pTriInfos[f].FaceNeighbors[i] = -1;
-			pTriInfos[f].AssignedGroup[i] = NULL;
+	ForEachRange(iNrTrianglesIn, bParallel, [&](const int iBegin, const int iEnd) {
+		int f=0, i=0;
 
-			pTriInfos[f].vOs.x=0.0f; pTriInfos[f].vOs.y=0.0f; pTriInfos[f].vOs.z=0.0f;
-			pTriInfos[f].vOt.x=0.0f; pTriInfos[f].vOt.y=0.0f; pTriInfos[f].vOt.z=0.0f;
-			pTriInfos[f].fMagS = 0;
-			pTriInfos[f].fMagT = 0;
+		// generate neighbor info list
+		for (f=iBegin; f<iEnd; f++)
+			for (i=0; i<3; i++)
+			{
+				pTriInfos[f].FaceNeighbors[i] = -1;
+				pTriInfos[f].AssignedGroup[i] = NULL;
 
-			// assumed bad
-			pTriInfos[f].iFlag |= GROUP_WITH_ANY;
-		}
+				pTriInfos[f].vOs.x=0.0f; pTriInfos[f].vOs.y=0.0f; pTriInfos[f].vOs.z=0.0f;
+				pTriInfos[f].vOt.x=0.0f; pTriInfos[f].vOt.y=0.0f; pTriInfos[f].vOt.z=0.0f;
+				pTriInfos[f].fMagS = 0;
+				pTriInfos[f].fMagT = 0;
 
-	// evaluate first order derivatives
-	for (f=0; f<iNrTrianglesIn; f++)
-	{
-		// initial values
-		const SVec3 v1 = GetPosition(pContext, piTriListIn[f*3+0]);
-		const SVec3 v2 = GetPosition(pContext, piTriListIn[f*3+1]);
-		const SVec3 v3 = GetPosition(pContext, piTriListIn[f*3+2]);
-		const SVec3 t1 = GetTexCoord(pContext, piTriListIn[f*3+0]);
-		const SVec3 t2 = GetTexCoord(pContext, piTriListIn[f*3+1]);
-		const SVec3 t3 = GetTexCoord(pContext, piTriListIn[f*3+2]);
-
-		const float t21x = t2.x-t1.x;
-		const float t21y = t2.y-t1.y;
-		const float t31x = t3.x-t1.x;
-		const float t31y = t3.y-t1.y;
-		const SVec3 d1 = vsub(v2,v1);
-		const SVec3 d2 = vsub(v3,v1);
-
-		const float fSignedAreaSTx2 = t21x*t31y - t21y*t31x;
-		//assert(fSignedAreaSTx2!=0);
-		SVec3 vOs = vsub(vscale(t31y,d1), vscale(t21y,d2));	// eq 18
-		SVec3 vOt = vadd(vscale(-t31x,d1), vscale(t21x,d2)); // eq 19
-
-		pTriInfos[f].iFlag |= (fSignedAreaSTx2>0 ? ORIENT_PRESERVING : 0);
-
-		if ( NotZero(fSignedAreaSTx2) )
+				// assumed bad
+				pTriInfos[f].iFlag |= GROUP_WITH_ANY;
+			}
+
+		// evaluate first order derivatives
+		for (f=iBegin; f<iEnd; f++)
 		{
-			const float fAbsArea = fabsf(fSignedAreaSTx2);
-			const float fLenOs = Length(vOs);
-			const float fLenOt = Length(vOt);
-			const float fS = (pTriInfos[f].iFlag&ORIENT_PRESERVING)==0 ? (-1.0f) : 1.0f;
-			if ( NotZero(fLenOs) ) pTriInfos[f].vOs = vscale(fS/fLenOs, vOs);
-			if ( NotZero(fLenOt) ) pTriInfos[f].vOt = vscale(fS/fLenOt, vOt);
-
-			// evaluate magnitudes prior to normalization of vOs and vOt
-			pTriInfos[f].fMagS = fLenOs / fAbsArea;
-			pTriInfos[f].fMagT = fLenOt / fAbsArea;
-
-			// if this is a good triangle
-			if ( NotZero(pTriInfos[f].fMagS) && NotZero(pTriInfos[f].fMagT))
-				pTriInfos[f].iFlag &= (~GROUP_WITH_ANY);
+			// initial values
+			const SVec3 v1 = GetPosition(pContext, piTriListIn[f*3+0]);
+			const SVec3 v2 = GetPosition(pContext, piTriListIn[f*3+1]);
+			const SVec3 v3 = GetPosition(pContext, piTriListIn[f*3+2]);
+			const SVec3 t1 = GetTexCoord(pContext, piTriListIn[f*3+0]);
+			const SVec3 t2 = GetTexCoord(pContext, piTriListIn[f*3+1]);
+			const SVec3 t3 = GetTexCoord(pContext, piTriListIn[f*3+2]);
+
+			const float t21x = t2.x-t1.x;
+			const float t21y = t2.y-t1.y;
+			const float t31x = t3.x-t1.x;
+			const float t31y = t3.y-t1.y;
+			const SVec3 d1 = vsub(v2,v1);
+			const SVec3 d2 = vsub(v3,v1);
+
+			const float fSignedAreaSTx2 = t21x*t31y - t21y*t31x;
+			//assert(fSignedAreaSTx2!=0);
+			SVec3 vOs = vsub(vscale(t31y,d1), vscale(t21y,d2));	// eq 18
+			SVec3 vOt = vadd(vscale(-t31x,d1), vscale(t21x,d2)); // eq 19
+
+			pTriInfos[f].iFlag |= (fSignedAreaSTx2>0 ? ORIENT_PRESERVING : 0);
+
+			if ( NotZero(fSignedAreaSTx2) )
+			{
+				const float fAbsArea = fabsf(fSignedAreaSTx2);
+				const float fLenOs = Length(vOs);
+				const float fLenOt = Length(vOt);
+				const float fS = (pTriInfos[f].iFlag&ORIENT_PRESERVING)==0 ? (-1.0f) : 1.0f;
+				if ( NotZero(fLenOs) ) pTriInfos[f].vOs = vscale(fS/fLenOs, vOs);
+				if ( NotZero(fLenOt) ) pTriInfos[f].vOt = vscale(fS/fLenOt, vOt);
+
+				// evaluate magnitudes prior to normalization of vOs and vOt
+				pTriInfos[f].fMagS = fLenOs / fAbsArea;
+				pTriInfos[f].fMagT = fLenOt / fAbsArea;
+
+				// if this is a good triangle
+				if ( NotZero(pTriInfos[f].fMagS) && NotZero(pTriInfos[f].fMagT))
+					pTriInfos[f].iFlag &= (~GROUP_WITH_ANY);
+			}
 		}
-	}
+	});
 
 	// force otherwise healthy quads to a fixed orientation
 	while (t<(iNrTrianglesIn-1))
@@ -1185,20 +1244,39 @@ static tbool CompareSubGroups(const SSubGroup * pg1, const SSubGroup * pg2);
 static void QuickSort(int* pSortBuffer, int iLeft, int iRight, unsigned int uSeed);
 static STSpace EvalTspace(int face_indices[], const int iFaces, const int piTriListIn[], const STriInfo pTriInfos[], const SMikkTSpaceContext * pContext, const int iVertexRepresentitive);
 
+static tbool GenerateTSpacesForGroups(STSpace psTspace[], const STriInfo pTriInfos[], const SGroup pGroups[],
+                                      const int iGroupBegin, const int iGroupEnd, const int iMaxNrFaces,
+                                      const int piTriListIn[], const float fThresCos, const SMikkTSpaceContext * pContext);
+
 static tbool GenerateTSpaces(STSpace psTspace[], const STriInfo pTriInfos[], const SGroup pGroups[],
                              const int iNrActiveGroups, const int piTriListIn[], const float fThresCos,
-                             const SMikkTSpaceContext * pContext)
+                             const SMikkTSpaceContext * pContext, const tbool bParallel)
 {
-	STSpace * pSubGroupTspace = NULL;
-	SSubGroup * pUniSubGroups = NULL;
-	int * pTmpMembers = NULL;
-	int iMaxNrFaces=0, iUniqueTspaces=0, g=0, i=0;
+	std::atomic<bool> bAllocFailed(false);
+	int iMaxNrFaces=0, g=0;
 	for (g=0; g<iNrActiveGroups; g++)
 		if (iMaxNrFaces < pGroups[g].iNrFaces)
 			iMaxNrFaces = pGroups[g].iNrFaces;
 
 	if (iMaxNrFaces == 0) return TTRUE;
 
+	ForEachRange(iNrActiveGroups, bParallel, [&](const int iBegin, const int iEnd) {
+		if (!GenerateTSpacesForGroups(psTspace, pTriInfos, pGroups, iBegin, iEnd, iMaxNrFaces, piTriListIn, fThresCos, pContext))
+			bAllocFailed = true;
+	});
+
+	return bAllocFailed ? TFALSE : TTRUE;
+}
+
+static tbool GenerateTSpacesForGroups(STSpace psTspace[], const STriInfo pTriInfos[], const SGroup pGroups[],
+                                      const int iGroupBegin, const int iGroupEnd, const int iMaxNrFaces,
+                                      const int piTriListIn[], const float fThresCos, const SMikkTSpaceContext * pContext)
+{
+	STSpace * pSubGroupTspace = NULL;
+	SSubGroup * pUniSubGroups = NULL;
+	int * pTmpMembers = NULL;
+	int g=0, i=0;
+
 	// make initial allocations
 	pSubGroupTspace = (STSpace *) malloc(sizeof(STSpace)*iMaxNrFaces);
 	pUniSubGroups = (SSubGroup *) malloc(sizeof(SSubGroup)*iMaxNrFaces);
@@ -1212,8 +1290,7 @@ static tbool GenerateTSpaces(STSpace psTspace[], const STriInfo pTriInfos[], con
 	}
 
 
-	iUniqueTspaces = 0;
-	for (g=0; g<iNrActiveGroups; g++)
+	for (g=iGroupBegin; g<iGroupEnd; g++)
 	{
 		const SGroup * pGroup = &pGroups[g];
 		int iUniqueSubGroups = 0, s=0;
@@ -1340,10 +1417,9 @@ static tbool GenerateTSpaces(STSpace psTspace[], const STriInfo pTriInfos[], con
 			}
 		}
 
-		// clean up and offset iUniqueTspaces
+		// clean up
 		for (s=0; s<iUniqueSubGroups; s++)
 			free(pUniSubGroups[s].pTriMembers);
-		iUniqueTspaces += iUniqueSubGroups;
 	}
 
 	// clean up
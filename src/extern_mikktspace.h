@@ -110,6 +110,11 @@ struct SMikkTSpaceContext
 tbool genTangSpaceDefault(const SMikkTSpaceContext * pContext);	// Default (recommended) fAngularThreshold is 180 degrees (which means threshold disabled)
 tbool genTangSpace(const SMikkTSpaceContext * pContext, const float fAngularThreshold);
 
+// Altered for Cycles for Max: multithreaded versions of the above which produce identical results.
+// The getter callbacks will be called concurrently from multiple threads and must be safe to do so.
+tbool genTangSpaceDefaultParallel(const SMikkTSpaceContext * pContext);
+tbool genTangSpaceParallel(const SMikkTSpaceContext * pContext, const float fAngularThreshold);
+
 
 // To avoid visual errors (distortions/unwanted hard edges in lighting), when using sampled normal maps, the
 // normal map sampler must use the exact inverse of the pixel shader transformation.
@@ -22,81 +22,6 @@
 
 constexpr size_t BACKPLATE_CHANNELS = 3;
 
-AccumulationBuffer::AccumulationBuffer(const int width, const int height, const std::vector<RenderPassInfo>& render_pass_info_vec) :
-	width(width), height(height)
-{
-	constexpr int COMBINED_PASS_CHANNELS = 4;
-	pass_offsets["Combined"] = 0;
-
-	int total_channels = COMBINED_PASS_CHANNELS; // Start with just combined pass
-	for (const RenderPassInfo this_info : render_pass_info_vec) {
-		if (this_info.channels == 0) {
-			continue;
-		}
-		if (pass_offsets.count(this_info.name) == 0) {
-			pass_offsets[this_info.name] = total_channels;
-			total_channels += this_info.channels;
-		}
-	}
-
-	const size_t buffer_size = num_pixels() * total_channels;
-	data = new float[buffer_size];
-	
-	// Initialize all passes
-	// To 0.0f for one-channel
-	// To (0.0f, 0.0f, 0.0f, 1.0f) for four-channel
-	for (const RenderPassInfo this_info : render_pass_info_vec) {
-		float* const this_pass_buffer = get_pass_buffer(this_info.name);
-		if (this_info.channels == 1) {
-			for (int i = 0; i < num_pixels() * this_info.channels; i++) {
-				this_pass_buffer[i] = 0.0f;
-			}
-		}
-		else if (this_info.channels == 4) {
-			for (int i = 0; i < num_pixels() * this_info.channels; i++) {
-				if (i % 4 == 3) {
-					this_pass_buffer[i] = 1.0f;
-				}
-				else {
-					this_pass_buffer[i] = 0.0f;
-				}
-			}
-		}
-	}
-}
-
-AccumulationBuffer::~AccumulationBuffer()
-{
-	if (data != nullptr) {
-		delete data;
-		data = nullptr;
-	}
-}
-
-size_t AccumulationBuffer::num_pixels() const
-{
-	return static_cast<size_t>(get_width()) * get_height();
-}
-
-int AccumulationBuffer::get_width() const
-{
-	return width;
-}
-
-int AccumulationBuffer::get_height() const
-{
-	return height;
-}
-
-float* AccumulationBuffer::get_pass_buffer(const std::string name) const
-{
-	if (pass_offsets.count(name) == 1) {
-		return data + num_pixels() * pass_offsets.at(name);
-	}
-	// Default to combined pass
-	return data;
-}
-
 ConstantColorFrameBufferReader::ConstantColorFrameBufferReader(const BMM_Color_fl color, const Int2 resolution) :
 	color(color),
 	resolution(resolution)
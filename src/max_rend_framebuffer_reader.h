@@ -22,41 +22,15 @@
  * @brief Defines classes that can load Cycles render buffer data into the Max framebuffer.
  */
 
-#include <map>
 #include <memory>
-#include <vector>
 
 #include <RenderingAPI/Renderer/IFrameBufferProcessor.h>
 
-#include "util_pass.h"
+#include "rend_accum_buffer.h"
 #include "util_simple_types.h"
 
 class ToneOperator;
 
-/**
- * @brief Class to store a full frame buffer created from multiple Cycles render tiles.
- */
-class AccumulationBuffer {
-public:
-	AccumulationBuffer(int width, int height, const std::vector<RenderPassInfo>& render_pass_info_vec);
-	~AccumulationBuffer();
-
-	size_t num_pixels() const;
-
-	int get_width() const;
-	int get_height() const;
-
-	float* get_pass_buffer(std::string name) const;
-
-private:
-	const int width;
-	const int height;
-
-	float* data = nullptr;
-
-	std::map<std::string, int> pass_offsets;
-};
-
 /**
  * @brief Class to set the Max framebuffer to a constant color.
  */
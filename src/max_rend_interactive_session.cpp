@@ -32,9 +32,11 @@
 #include "rend_logger_ext.h"
 #include "rend_shader_manager.h"
 #include "trans_scene.h"
+#include "util_cycles_film.h"
 #include "util_cycles_integrator.h"
 #include "util_cycles_params.h"
 #include "util_cycles_status.h"
+#include "util_pass.h"
 #include "util_translate_camera.h"
 #include "util_translate_environment.h"
 #include "util_translate_geometry.h"
@@ -165,6 +167,7 @@ bool CyclesInteractiveRenderSession::UpdateInteractiveSession(const TimeValue t,
 
 		bool baking_done = texmap_cache->bake_texmaps_iteration();
 		if (baking_done) {
+			*logger << "Baked texmap memory (bytes): " << texmap_cache->get_baked_memory_usage() << LogCtl::WRITE_LINE;
 			session_context.CallRenderEnd(t);
 			cycles_session->start(0);
 			state = SessionState::RENDERING;
@@ -275,8 +278,15 @@ bool CyclesInteractiveRenderSession::BuildCyclesSession(CyclesSceneDescriptor& s
 		threads--;
 	}
 
+	// ActiveShade only displays the combined pass, but adaptive sampling needs its auxiliary passes as it does offline
+	std::vector<RenderPassInfo> pass_info_vec;
+	pass_info_vec.push_back(RenderPassInfo());
+	if (rend_params.use_adaptive_sampling) {
+		append_adaptive_sampling_passes(pass_info_vec);
+	}
+
 	// We don't need to get the session_width/height because activeshade will always use the final resolution
-	const ccl::BufferParams buffer_params = get_buffer_params(scene_desc.camera_params.final_resolution);
+	const ccl::BufferParams buffer_params = get_buffer_params(scene_desc.camera_params.final_resolution, pass_info_vec);
 
 	const boost::optional<ccl::SessionParams> opt_session_params{ get_session_params(rend_params) };
 	if (opt_session_params.has_value() == false) {
@@ -285,19 +295,18 @@ bool CyclesInteractiveRenderSession::BuildCyclesSession(CyclesSceneDescriptor& s
 	ccl::SessionParams session_params = *opt_session_params;
 
 	session_params.progressive_update_timeout = 0.08f;
+	session_params.start_resolution = get_start_resolution(scene_desc.camera_params.final_resolution, rend_params.activeshade_start_divider);
+	session_params.pixel_size = 1;
 
 	*logger << "Creating session" << LogCtl::WRITE_LINE;
 
 	// Create session and fill in appropriate parameters
-	std::vector<RenderPassInfo> default_pass_vec;
-	default_pass_vec.push_back(RenderPassInfo());
-
 	resolutions = RenderResolutions(
 		scene_desc.camera_params.final_resolution.x(),
 		scene_desc.camera_params.final_resolution.y(),
 		STEREO_TYPE);
 
-	cycles_session = std::make_unique<CyclesSession>(session_params, rend_params, resolutions, default_pass_vec);
+	cycles_session = std::make_unique<CyclesSession>(session_params, rend_params, resolutions, pass_info_vec);
 	cycles_session->reset_and_cache(buffer_params, session_params.samples);
 
 	const ccl::SceneParams scene_params = get_scene_params();
@@ -308,12 +317,11 @@ bool CyclesInteractiveRenderSession::BuildCyclesSession(CyclesSceneDescriptor& s
 
 	cycles_scene->background->set_transparent(rend_params.use_transparent_sky);
 
-	*logger << "Setting film exposure to: " << rend_params.exposure_multiplier << LogCtl::WRITE_LINE;
-
-	cycles_scene->film->set_exposure(rend_params.exposure_multiplier);
-
 	assert(cycles_scene->integrator != nullptr);
 	apply_integrator_params(*(cycles_scene->integrator), rend_params, scene_desc.camera_params);
+	assert(cycles_scene->film != nullptr);
+	apply_film_params(*(cycles_scene->film), rend_params);
+	cycles_scene->film->tag_passes_update(cycles_scene, buffer_params.passes);
 
 	cycles_session->scene = cycles_scene;
 
@@ -331,7 +339,7 @@ bool CyclesInteractiveRenderSession::BuildCyclesSession(CyclesSceneDescriptor& s
 
 	// Copy lights
 	for (CyclesLightParams light_params : scene_desc.scene_lights.lights) {
-		add_light_to_scene(cycles_scene, shader_manager, light_params, rend_params.point_light_size);
+		add_light_to_scene(cycles_scene, shader_manager, light_params, rend_params);
 	}
 
 	*logger << "Completed adding lights" << LogCtl::WRITE_LINE;
@@ -368,6 +376,10 @@ void CyclesInteractiveRenderSession::BuildGeometry(CyclesSceneGeometryList& geom
 		*logger << "Copy complete" << LogCtl::WRITE_LINE;
 	}
 
+	if (rend_params.auto_emission_mis) {
+		shader_manager->update_emission_mis(rend_params.auto_emission_mis_threshold);
+	}
+
 	// Shader manager is no longer needed, dispose of it here
 	shader_manager.reset(nullptr);
 
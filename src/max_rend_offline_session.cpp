@@ -17,16 +17,45 @@
  
 #include "max_rend_offline_session.h"
 
+#include <bitmap.h>
+#include <maxapi.h>
 #include <Rendering/Renderer.h>
 #include <RenderingAPI/Renderer/IRenderSettingsContainer.h>
 #include <RenderingAPI/Renderer/IRenderingLogger.h>
 
 #include "cache_baked_texmap.h"
 #include "rend_offline_frame_man.h"
+#include "rend_perf_trace.h"
 #include "util_cycles_device_dump.h"
+#include "util_windows.h"
 
 using MaxSDK::RenderingAPI::IRenderSessionContext;
 
+// Returns a path next to the render output if the render is being saved, otherwise in the log directory
+static std::wstring get_debug_output_path(const std::wstring& tag, const std::wstring& extension, const TimeValue frame_t)
+{
+	std::wstring base_path;
+	Interface* const core_interface = GetCOREInterface();
+	if (core_interface->GetRendSaveFile() && core_interface->GetRendFileBI().Name() != nullptr) {
+		base_path = core_interface->GetRendFileBI().Name();
+		const size_t last_slash = base_path.find_last_of(L"\\/");
+		const size_t last_dot = base_path.find_last_of(L'.');
+		if (last_dot != std::wstring::npos && (last_slash == std::wstring::npos || last_dot > last_slash)) {
+			base_path = base_path.substr(0, last_dot);
+		}
+	}
+	if (base_path.empty()) {
+		const std::wstring log_dir = get_user_dir() + L"\\CyclesMaxLog";
+		create_directory(log_dir);
+		base_path = log_dir + L"\\render";
+	}
+
+	wchar_t frame_buffer[16];
+	swprintf_s(frame_buffer, L"%04d", frame_t / GetTicksPerFrame());
+
+	return base_path + L"_" + tag + L"_" + frame_buffer + extension;
+}
+
 CyclesOfflineRenderSession::CyclesOfflineRenderSession(IRenderSessionContext& session_context, const CyclesRenderParams& rend_params) :
 	texmap_cache{ std::make_unique<BakedTexmapCache>(session_context, rend_params.texmap_bake_width, rend_params.texmap_bake_height) },
 	session_context{ session_context },
@@ -53,6 +82,7 @@ bool CyclesOfflineRenderSession::TranslateScene(const TimeValue t)
 	}
 
 	frame_manager = std::unique_ptr<OfflineFrameManager>{};
+	perf_trace = std::unique_ptr<FramePerfTrace>{};
 
 	rend_params.in_mtl_edit = session_context.GetRenderSettings().GetIsMEditRender();
 	rend_params.std_render_hidden = session_context.GetRenderSettings().GetRenderHiddenObjects();
@@ -63,11 +93,31 @@ bool CyclesOfflineRenderSession::TranslateScene(const TimeValue t)
 
 	*logger << "Translating frame..." << LogCtl::WRITE_LINE;
 
+	if (rend_params.perf_trace_format != PerfTraceFormat::NONE && rend_params.in_mtl_edit == false) {
+		perf_trace = std::make_unique<FramePerfTrace>();
+	}
+
 	texmap_cache->new_frame(rend_params.frame_t);
-	frame_manager = std::make_unique<OfflineFrameManager>(session_context, *texmap_cache, rend_params);
-	frame_manager->translate();
+	frame_manager = std::make_unique<OfflineFrameManager>(session_context, *texmap_cache, rend_params, perf_trace.get());
+	{
+		PerfTraceScope trace_scope{ perf_trace.get(), "translate" };
+		frame_manager->translate();
+	}
 
-	texmap_cache->bake_all_texmaps();
+	{
+		PerfTraceScope trace_scope{ perf_trace.get(), "bake_all_texmaps" };
+		texmap_cache->bake_all_texmaps();
+	}
+
+	if (rend_params.write_scene_snapshot && rend_params.in_mtl_edit == false) {
+		const std::wstring snapshot_path = get_debug_output_path(L"scene", L".xml", rend_params.frame_t);
+		*logger << "Writing scene snapshot: " << snapshot_path.c_str() << LogCtl::WRITE_LINE;
+		std::string snapshot_error;
+		if (frame_manager->write_scene_snapshot(snapshot_path, snapshot_error) == false) {
+			const std::wstring message = L"Failed to write scene snapshot " + snapshot_path + L": " + std::wstring(snapshot_error.begin(), snapshot_error.end());
+			session_context.GetLogger().LogMessage(MaxSDK::RenderingAPI::IRenderingLogger::MessageType::Warning, message.c_str());
+		}
+	}
 
 	session_context.CallRenderEnd(rend_params.frame_t);
 
@@ -83,7 +133,11 @@ bool CyclesOfflineRenderSession::RenderOfflineFrame(const TimeValue)
 	*logger << "RenderOfflineFrame called..." << LogCtl::WRITE_LINE;
 
 	if (frame_manager) {
-		frame_manager->run_frame();
+		{
+			PerfTraceScope trace_scope{ perf_trace.get(), "run_frame" };
+			frame_manager->run_frame();
+		}
+		write_perf_trace();
 	}
 	else {
 		*logger << "frame_manager was not set, doing nothing..." << LogCtl::WRITE_LINE;
@@ -121,3 +175,29 @@ void CyclesOfflineRenderSession::ResumeRendering()
 {
 
 }
+
+void CyclesOfflineRenderSession::write_perf_trace()
+{
+	if (perf_trace.get() == nullptr) {
+		return;
+	}
+
+	const std::wstring extension = (rend_params.perf_trace_format == PerfTraceFormat::CSV) ? L".csv" : L".json";
+	const std::wstring trace_path = get_debug_output_path(L"perf", extension, rend_params.frame_t);
+	*logger << "Writing performance trace: " << trace_path.c_str() << LogCtl::WRITE_LINE;
+
+	bool write_success = false;
+	if (rend_params.perf_trace_format == PerfTraceFormat::CSV) {
+		write_success = perf_trace->write_csv(trace_path);
+	}
+	else {
+		write_success = perf_trace->write_chrome_json(trace_path);
+	}
+
+	if (write_success == false) {
+		const std::wstring message = L"Failed to write performance trace: " + trace_path;
+		session_context.GetLogger().LogMessage(MaxSDK::RenderingAPI::IRenderingLogger::MessageType::Warning, message.c_str());
+	}
+
+	perf_trace = std::unique_ptr<FramePerfTrace>{};
+}
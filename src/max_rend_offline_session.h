@@ -30,6 +30,7 @@
 #include "rend_params.h"
 
 class BakedTexmapCache;
+class FramePerfTrace;
 class OfflineFrameManager;
 
  /**
@@ -57,5 +58,10 @@ private:
 
 	std::unique_ptr<OfflineFrameManager> frame_manager;
 
+	// Only set when a performance trace was requested for the current frame
+	std::unique_ptr<FramePerfTrace> perf_trace;
+
+	void write_perf_trace();
+
 	const std::unique_ptr<LoggerInterface> logger;
 };
@@ -28,7 +28,7 @@
 enum { pblock_ref_general, pblock_ref_count };
 
 // Parameter enum
-enum { param_gen_shadow_catcher };
+enum { param_gen_shadow_catcher, param_gen_particle_spheres };
 
 static ParamBlockDesc2 mat_emission_pblock_desc(
 	// Pblock data
@@ -52,6 +52,15 @@ static ParamBlockDesc2 mat_emission_pblock_desc(
 		p_default, FALSE,
 		p_ui, TYPE_SINGLECHEKBOX, IDC_BOOL_PROP_SHADOW_CATCHER,
 		p_end,
+		// Particles as spheres on
+		param_gen_particle_spheres,
+		_T("particles_as_spheres"),
+		TYPE_BOOL,
+		0,
+		IDS_PARTICLE_SPHERES,
+		p_default, FALSE,
+		p_ui, TYPE_SINGLECHEKBOX, IDC_BOOL_PROP_PARTICLE_SPHERES,
+		p_end,
 	p_end
 	);
 
@@ -68,6 +77,14 @@ bool CyclesPropertiesMod::GetIsShadowCatcher(const TimeValue t)
 	return pblock_general->GetInt(param_gen_shadow_catcher, t) != 0;
 }
 
+bool CyclesPropertiesMod::GetRenderParticlesAsSpheres(const TimeValue t)
+{
+	if (pblock_general == nullptr) {
+		return false;
+	}
+	return pblock_general->GetInt(param_gen_particle_spheres, t) != 0;
+}
+
 ChannelMask CyclesPropertiesMod::ChannelsUsed()
 {
 	return 0;
@@ -236,3 +253,17 @@ void CyclesPropertiesMod::EndEditParams(IObjParam* const ip, const ULONG flags,
 {
 	GetCyclesPropertiesModifierClassDesc()->EndEditParams(ip, this, flags, prev);
 }
+
+CyclesPropertiesMod* get_node_properties_mod(INode* const node)
+{
+	if (node->GetObjectRef()->SuperClassID() == GEN_DERIVOB_CLASS_ID) {
+		IDerivedObject* const derived_object = dynamic_cast<IDerivedObject*>(node->GetObjectRef());
+		for (int i = 0; i < derived_object->NumModifiers(); i++) {
+			Modifier* const this_modifier = derived_object->GetModifier(i);
+			if (this_modifier != nullptr && this_modifier->ClassID() == CYCLES_MOD_PROPERTIES_CLASS) {
+				return dynamic_cast<CyclesPropertiesMod*>(this_modifier);
+			}
+		}
+	}
+	return nullptr;
+}
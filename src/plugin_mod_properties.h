@@ -33,6 +33,7 @@ public:
 	
 	// Access to properties
 	bool GetIsShadowCatcher(TimeValue t);
+	bool GetRenderParticlesAsSpheres(TimeValue t);
 
 	// From Modifier
 	virtual ChannelMask ChannelsUsed() override;
@@ -86,3 +87,8 @@ public:
 private:
 	IParamBlock2* pblock_general = nullptr;
 };
+
+/**
+ * @brief Returns the first Cycles Properties modifier on the given node, or nullptr if there is none.
+ */
+CyclesPropertiesMod* get_node_properties_mod(INode* node);
@@ -0,0 +1,54 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#pragma once
+
+/**
+ * @file
+ * @brief Defines AccumulationBuffer.
+ */
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "util_pass.h"
+
+/**
+ * @brief Class to store a full frame buffer created from multiple Cycles render tiles.
+ */
+class AccumulationBuffer {
+public:
+	AccumulationBuffer(int width, int height, const std::vector<RenderPassInfo>& render_pass_info_vec);
+	~AccumulationBuffer();
+
+	size_t num_pixels() const;
+
+	int get_width() const;
+	int get_height() const;
+
+	float* get_pass_buffer(std::string name) const;
+
+private:
+	const int width;
+	const int height;
+
+	float* data = nullptr;
+
+	std::map<std::string, int> pass_offsets;
+};
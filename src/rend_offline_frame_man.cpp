@@ -18,12 +18,19 @@
 #include "rend_offline_frame_man.h"
 
 #include <algorithm>
+#include <chrono>
 #include <set>
+#include <string>
 #include <thread>
 #include <vector>
 
 #include <render/background.h>
 #include <render/camera.h>
+#include <render/image.h>
+#include <render/light.h>
+#include <render/mesh.h>
+#include <render/object.h>
+#include <render/shader.h>
 
 #include <Rendering/RendProgressCallback.h>
 #include <RenderingAPI/Renderer/ICameraContainer.h>
@@ -36,6 +43,8 @@
 #include "max_rend_framebuffer_reader.h"
 #include "plugin_re_simple.h"
 #include "rend_params.h"
+#include "rend_perf_trace.h"
+#include "rend_scene_snapshot.h"
 #include "rend_update_timer.h"
 #include "util_cycles_device.h"
 #include "util_cycles_film.h"
@@ -58,10 +67,23 @@ static bool allow_render_passes(StereoscopyType stereo_type)
 		allowed_types.insert(StereoscopyType::NONE);
 		allowed_types.insert(StereoscopyType::LEFT_EYE);
 		allowed_types.insert(StereoscopyType::RIGHT_EYE);
+		allowed_types.insert(StereoscopyType::SPLIT_LEFT_RIGHT);
+		allowed_types.insert(StereoscopyType::SPLIT_TOP_BOTTOM);
 	}
 	return (allowed_types.count(stereo_type) == 1);
 }
 
+// Logs which parts of the scene will be synced to the device on the next session start
+static void log_scene_update_state(LoggerInterface& logger, ccl::Scene* const scene)
+{
+	logger << "pending update, camera: " << scene->camera->need_device_update << LogCtl::WRITE_LINE;
+	logger << "pending update, geometry: " << scene->geometry_manager->need_update << LogCtl::WRITE_LINE;
+	logger << "pending update, objects: " << scene->object_manager->need_update << LogCtl::WRITE_LINE;
+	logger << "pending update, shaders: " << scene->shader_manager->need_update << LogCtl::WRITE_LINE;
+	logger << "pending update, lights: " << scene->light_manager->need_update << LogCtl::WRITE_LINE;
+	logger << "pending update, images: " << scene->image_manager->need_update << LogCtl::WRITE_LINE;
+}
+
 enum class CryptomatteType {
 	OBJECT,
 	MATERIAL,
@@ -86,6 +108,33 @@ static CryptomatteType get_cryptomatte_type(CyclesRenderElement* const render_el
 	}
 }
 
+static void append_cryptomatte_passes(
+	std::vector<RenderPassInfo>& passes,
+	const std::vector<CyclesRenderElement*>& elements,
+	const size_t depth,
+	const RenderPassType type,
+	const char* const dummy_name)
+{
+	if (elements.size() == 0) {
+		return;
+	}
+
+	for (size_t i = 0; i < depth; i++) {
+		if (i < elements.size()) {
+			// Create a pass with a real render element
+			const RenderPassInfo this_info{ elements[i], i };
+			if (this_info.type != RenderPassType::INVALID) {
+				passes.push_back(this_info);
+			}
+		}
+		else {
+			// Create a dummy pass with no attached render element
+			const RenderPassInfo this_info{ type, ccl::PassType::PASS_CRYPTOMATTE, 4, dummy_name, i };
+			passes.push_back(this_info);
+		}
+	}
+}
+
 static std::vector<RenderPassInfo> get_render_pass_info(CyclesRenderParams& rend_params, MaxSDK::RenderingAPI::IRenderSessionContext& session_context)
 {
 	std::vector<RenderPassInfo> result;
@@ -93,7 +142,7 @@ static std::vector<RenderPassInfo> get_render_pass_info(CyclesRenderParams& rend
 	result.push_back(RenderPassInfo{});
 
 	if (allow_render_passes(rend_params.stereo_type) == false) {
-		// stereo rendering does not support render passes (yet)
+		// anaglyph rendering has no per-eye layout to write passes into
 		return result;
 	}
 
@@ -129,65 +178,16 @@ static std::vector<RenderPassInfo> get_render_pass_info(CyclesRenderParams& rend
 		}
 	}
 
+	// Cycles uses a single layer count for every enabled cryptomatte type, so each requested type is padded up to the
+	// deepest request. Types with no render elements are left disabled and get no passes at all.
 	const size_t max_size{ std::max(cryptomatte_object_elements.size(), std::max(cryptomatte_material_elements.size(), cryptomatte_asset_elements.size())) };
 
-	// Objects
-	for (size_t i = 0; i < max_size; i++) {
-		if (i < cryptomatte_object_elements.size()) {
-			// Create a pass with a real render element
-			CyclesRenderElement* const this_element{ cryptomatte_object_elements[i] };
-			const RenderPassInfo this_info{ this_element, i };
-			if (this_info.type != RenderPassType::INVALID) {
-				result.push_back(this_info);
-			}
-		}
-		else {
-			// Create a dummy pass with no attached render element
-			const RenderPassInfo this_info{ RenderPassType::CRYPTOMATTE_OBJ, ccl::PassType::PASS_CRYPTOMATTE, 4, "CryptoObject", i };
-			result.push_back(this_info);
-		}
-	}
-
-	// Materials
-	for (size_t i = 0; i < max_size; i++) {
-		if (i < cryptomatte_material_elements.size()) {
-			// Create a pass with a real render element
-			CyclesRenderElement* const this_element = cryptomatte_material_elements[i];
-			const RenderPassInfo this_info{ this_element, i };
-			if (this_info.type != RenderPassType::INVALID) {
-				result.push_back(this_info);
-			}
-		}
-		else {
-			// Create a dummy pass with no attached render element
-			const RenderPassInfo this_info{ RenderPassType::CRYPTOMATTE_MTL, ccl::PassType::PASS_CRYPTOMATTE, 4, "CryptoMaterial", i };
-			result.push_back(this_info);
-		}
-	}
-
-	// Assets
-	for (size_t i = 0; i < max_size; i++) {
-		if (i < cryptomatte_asset_elements.size()) {
-			// Create a pass with a real render element
-			CyclesRenderElement* const this_element = cryptomatte_asset_elements[i];
-			const RenderPassInfo this_info{ this_element, i };
-			if (this_info.type != RenderPassType::INVALID) {
-				result.push_back(this_info);
-			}
-		}
-		else {
-			// Create a dummy pass with no attached render element
-			const RenderPassInfo this_info{ RenderPassType::CRYPTOMATTE_ASSET, ccl::PassType::PASS_CRYPTOMATTE, 4, "CryptoAsset", i };
-			result.push_back(this_info);
-		}
-	}
+	append_cryptomatte_passes(result, cryptomatte_object_elements, max_size, RenderPassType::CRYPTOMATTE_OBJ, "CryptoObject");
+	append_cryptomatte_passes(result, cryptomatte_material_elements, max_size, RenderPassType::CRYPTOMATTE_MTL, "CryptoMaterial");
+	append_cryptomatte_passes(result, cryptomatte_asset_elements, max_size, RenderPassType::CRYPTOMATTE_ASSET, "CryptoAsset");
 
 	if (rend_params.use_adaptive_sampling) {
-		// Create a dummy pass with no attached render element
-		const RenderPassInfo aux_info{ RenderPassType::ADAPTIVE_AUX, ccl::PassType::PASS_ADAPTIVE_AUX_BUFFER, 4, "AdaptiveAuxBuffer", 0 };
-		result.push_back(aux_info);
-		const RenderPassInfo count_info{ RenderPassType::SAMPLE_COUNT, ccl::PassType::PASS_SAMPLE_COUNT, 1, "SampleCount", 0 };
-		result.push_back(count_info);
+		append_adaptive_sampling_passes(result);
 	}
 
 	return result;
@@ -239,17 +239,20 @@ static CryptoMatteInfo get_cryptomatte_info(const std::vector<RenderPassInfo>& p
 OfflineFrameManager::OfflineFrameManager(
 	MaxSDK::RenderingAPI::IRenderSessionContext& session_context,
 	BakedTexmapCache& texmap_cache,
-	CyclesRenderParams& rend_params
+	CyclesRenderParams& rend_params,
+	FramePerfTrace* const perf_trace
 	) :
 	translation_manager{
 		std::make_unique<OfflineTranslationManager>(
 			session_context,
 			texmap_cache,
-			rend_params
+			rend_params,
+			perf_trace
 		)
 	},
 	texmap_cache{ texmap_cache },
 	rend_params{ rend_params },
+	perf_trace{ perf_trace },
 	session_context{ session_context },
 	logger{ global_log_manager.new_logger(L"OfflineFrameManager") }
 {
@@ -345,6 +348,7 @@ void OfflineFrameManager::translate()
 			}
 
 			*logger << "Calling copy_scene..." << LogCtl::WRITE_LINE;
+			PerfTraceScope trace_scope{ perf_trace, "copy_scene" };
 			translation_manager->copy_scene(mblur_sample_ticks);
 		}
 		else {
@@ -355,6 +359,15 @@ void OfflineFrameManager::translate()
 	*logger << "translate end" << LogCtl::WRITE_LINE;
 }
 
+bool OfflineFrameManager::write_scene_snapshot(const std::wstring& path, std::string& error_out)
+{
+	if (frame_errored) {
+		error_out = "frame failed to translate";
+		return false;
+	}
+	return ::write_scene_snapshot(translation_manager->scene, texmap_cache, path, *logger, error_out);
+}
+
 void OfflineFrameManager::run_frame()
 {
 	if (frame_errored) {
@@ -399,12 +412,20 @@ void OfflineFrameManager::run_frame_internal()
 		*logger << "++++++++ RENDER LOOP BEGIN ++++++++" << LogCtl::WRITE_LINE;
 		*logger << "camera: " << cameras_rendered << LogCtl::WRITE_LINE;
 
+		PerfTraceScope camera_trace_scope{ perf_trace, "camera " + std::to_string(cameras_rendered) };
+
 		setup_stereo_camera(cameras_rendered);
 		*logger << "stereo updated" << LogCtl::WRITE_LINE;
 
+		// The device scene built for the first eye is reused, only the camera should be waiting for an update here
+		if (cameras_rendered > 0) {
+			log_scene_update_state(*logger, session->scene);
+		}
+
 		session->reset_with_cache();
 		session->progress.reset();
 
+		const std::chrono::steady_clock::time_point session_start_time = std::chrono::steady_clock::now();
 		session->start(cameras_rendered);
 
 		*logger << "setting status..." << LogCtl::WRITE_LINE;
@@ -413,7 +434,10 @@ void OfflineFrameManager::run_frame_internal()
 		*logger << "stereo_eye: " << session->scene->camera->get_stereo_eye() << LogCtl::WRITE_LINE;
 		*logger << "beginning loop..." << LogCtl::WRITE_LINE;
 
-		render_status_loop();
+		{
+			PerfTraceScope trace_scope{ perf_trace, "render_status_loop" };
+			render_status_loop();
+		}
 
 		*logger << "loop complete" << LogCtl::WRITE_LINE;
 
@@ -426,7 +450,30 @@ void OfflineFrameManager::run_frame_internal()
 		// Wait for the session to end cleanly as we may want to fiddle with the camera and then re-render for stereoscopy
 		wait_for_session_end();
 
-		session->copy_accum_buffer(session_context, true);
+		{
+			// In background mode cycles counts time spent syncing the scene to the device as total time but not render time
+			double total_time{ 0.0 };
+			double render_time{ 0.0 };
+			session->progress.get_time(total_time, render_time);
+			*logger << "camera " << cameras_rendered << " scene update time: " << static_cast<float>(total_time - render_time) << "s, render time: " << static_cast<float>(render_time) << "s" << LogCtl::WRITE_LINE;
+
+			if (perf_trace != nullptr) {
+				// Cycles does not report BVH build separately, it is part of the device update
+				const double device_update_time{ total_time - render_time };
+				const std::chrono::steady_clock::time_point sampling_start_time{
+					session_start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(device_update_time))
+				};
+				// Device memory is only tracked as a peak over the whole session
+				const size_t device_memory_peak{ session->stats.mem_peak };
+				perf_trace->add_phase("device_update", session_start_time, device_update_time, device_memory_peak);
+				perf_trace->add_phase("sampling", sampling_start_time, render_time, device_memory_peak);
+			}
+		}
+
+		{
+			PerfTraceScope trace_scope{ perf_trace, "framebuffer_readback" };
+			session->copy_accum_buffer(session_context, true);
+		}
 
 		cameras_rendered++;
 	}
@@ -24,12 +24,14 @@
 
 #include <atomic>
 #include <memory>
+#include <string>
 
 #include "cycles_session.h"
 #include "rend_logger.h"
 #include "rend_offline_translation_man.h"
 
 class BakedTexmapCache;
+class FramePerfTrace;
 
 /**
  * @brief This class is responsible for encapsulating all data needed to render a frame, including a CyclesSession.
@@ -40,11 +42,15 @@ public:
 	OfflineFrameManager(
 		MaxSDK::RenderingAPI::IRenderSessionContext& session_context,
 		BakedTexmapCache& texmap_cache,
-		CyclesRenderParams& rend_params
+		CyclesRenderParams& rend_params,
+		FramePerfTrace* perf_trace = nullptr
 	);
 
 	void translate();
 
+	// Writes the translated scene to disk, texmaps must already be baked
+	bool write_scene_snapshot(const std::wstring& path, std::string& error_out);
+
 	void run_frame();
 	void end_render();
 
@@ -56,6 +62,9 @@ private:
 	MaxSDK::RenderingAPI::IRenderSessionContext& session_context;
 	CyclesRenderParams& rend_params;
 
+	// May be null, phases are only recorded when a trace was requested
+	FramePerfTrace* const perf_trace;
+
 	std::unique_ptr<CyclesSession> session;
 
 	std::atomic<bool> stop_requested{ false };
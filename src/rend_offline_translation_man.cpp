@@ -17,12 +17,17 @@
  
 #include "rend_offline_translation_man.h"
 
+#include <algorithm>
+#include <set>
 #include <sstream>
 
+#include <render/hair.h>
 #include <render/light.h>
 #include <render/mesh.h>
 #include <render/object.h>
+#include <util/util_hash.h>
 
+#include <imtl.h>
 #include <inode.h>
 #include <IParticleObjectExt.h>
 #include <Rendering/Renderer.h>
@@ -33,15 +38,19 @@
 #include <RenderingAPI/Renderer/IRenderingProcess.h>
 #include <units.h>
 
+#include "cache_baked_texmap.h"
 #include "const_classid.h"
 #include "cycles_image.h"
 #include "extern_tyflow.h"
 #include "rend_logger_ext.h"
 #include "rend_params.h"
+#include "rend_perf_trace.h"
 #include "rend_shader_manager.h"
 #include "util_cycles_params.h"
 #include "util_matrix_max.h"
+#include "util_sphere_cloud.h"
 #include "util_sphere_mesh.h"
+#include "util_translate_camera.h"
 #include "util_translate_environment.h"
 #include "util_translate_geometry.h"
 #include "util_translate_light.h"
@@ -50,6 +59,10 @@ namespace ccl {
 	class Mesh;
 }
 
+// tyFlow does not have a dedicated identifier for Cycles, request the generic instance data rather than
+// the data prepared for another renderer
+static const unsigned int TYFLOW_PLUGIN_ID{ tyParticleObjectExt2::plugin_default };
+
 static ccl::float3 get_float3_from_colorref(const COLORREF input)
 {
 	ccl::float3 output;
@@ -85,15 +98,38 @@ static std::string get_asset_name(INode* const node)
 	return bad_from_wstring(current_node->GetName());
 }
 
+// Adds every texmap referenced by a material or texmap to the given set, including those of sub-materials
+static void collect_texmaps(MtlBase* const mtl_base, std::set<Texmap*>& texmaps)
+{
+	for (int i = 0; i < mtl_base->NumSubTexmaps(); i++) {
+		Texmap* const sub_texmap = mtl_base->GetSubTexmap(i);
+		if (sub_texmap != nullptr && texmaps.insert(sub_texmap).second) {
+			collect_texmaps(sub_texmap, texmaps);
+		}
+	}
+
+	if (mtl_base->SuperClassID() == MATERIAL_CLASS_ID) {
+		Mtl* const mtl = static_cast<Mtl*>(mtl_base);
+		for (int i = 0; i < mtl->NumSubMtls(); i++) {
+			Mtl* const sub_mtl = mtl->GetSubMtl(i);
+			if (sub_mtl != nullptr) {
+				collect_texmaps(sub_mtl, texmaps);
+			}
+		}
+	}
+}
+
 OfflineTranslationManager::OfflineTranslationManager(
 	MaxSDK::RenderingAPI::IRenderSessionContext& session_context,
 	BakedTexmapCache& texmap_cache,
-	CyclesRenderParams& rend_params
+	CyclesRenderParams& rend_params,
+	FramePerfTrace* const perf_trace
 	) :
 	session_context(session_context),
 	rend_params(rend_params),
 	frame_t(rend_params.frame_t),
 	texmap_cache(texmap_cache),
+	perf_trace(perf_trace),
 	logger(global_log_manager.new_logger(L"OfflineTranslationManager"))
 {
 	*logger << LogCtl::SEPARATOR;
@@ -133,20 +169,30 @@ void OfflineTranslationManager::copy_scene(const std::vector<int>& mblur_sample_
 		add_mtl_preview_lights_new();
 	}
 
-	CyclesEnvironmentParams env_params = get_environment_params(session_context, frame_t);
-	apply_environment_params(env_params, rend_params, shader_manager);
+	{
+		PerfTraceScope trace_scope{ perf_trace, "environment" };
+		CyclesEnvironmentParams env_params = get_environment_params(session_context, frame_t);
+		apply_environment_params(env_params, rend_params, shader_manager);
+	}
 
 	Interval geom_nodes_valid = FOREVER;
 	const std::vector<INode*> geom_nodes = session_context.GetScene().GetGeometricNodes(frame_t, geom_nodes_valid);
 
 	*logger << "Found " << geom_nodes.size() << " geom nodes" << LogCtl::WRITE_LINE;
 
-	for (INode* const geom_node : geom_nodes) {
-		if (should_stop()) {
-			*logger << "Ending geom node translation early"<< LogCtl::WRITE_LINE;
-			break;
+	if (rend_params.texmap_bake_screen_size && rend_params.in_mtl_edit == false) {
+		update_texmap_screen_sizes(geom_nodes);
+	}
+
+	{
+		PerfTraceScope trace_scope{ perf_trace, "geometry_nodes" };
+		for (INode* const geom_node : geom_nodes) {
+			if (should_stop()) {
+				*logger << "Ending geom node translation early"<< LogCtl::WRITE_LINE;
+				break;
+			}
+			add_node_to_scene(geom_node, mblur_sample_ticks);
 		}
-		add_node_to_scene(geom_node, mblur_sample_ticks);
 	}
 
 	Interval light_nodes_valid = FOREVER;
@@ -154,19 +200,109 @@ void OfflineTranslationManager::copy_scene(const std::vector<int>& mblur_sample_
 
 	*logger << "Found " << light_nodes.size() << " light nodes" << LogCtl::WRITE_LINE;
 
-	for (INode* const light_node : light_nodes) {
-		if (should_stop()) {
-			*logger << "Ending light node translation early" << LogCtl::WRITE_LINE;
-			break;
+	{
+		PerfTraceScope trace_scope{ perf_trace, "light_nodes" };
+		for (INode* const light_node : light_nodes) {
+			if (should_stop()) {
+				*logger << "Ending light node translation early" << LogCtl::WRITE_LINE;
+				break;
+			}
+			add_node_to_scene(light_node, mblur_sample_ticks);
 		}
-		add_node_to_scene(light_node, mblur_sample_ticks);
 	}
 
-	*logger << "Unique geometry count: " << scene->geometry.size() << LogCtl::WRITE_LINE;
+	log_scene_statistics();
+
+	if (rend_params.auto_emission_mis) {
+		shader_manager->update_emission_mis(rend_params.auto_emission_mis_threshold);
+	}
+
 	*logger << "Logging shader stats..." << LogCtl::WRITE_LINE;
 	shader_manager->log_shader_stats();
 }
 
+void OfflineTranslationManager::log_scene_statistics()
+{
+	size_t face_count = 0;
+	for (const ccl::Geometry* const this_geom : scene->geometry) {
+		if (this_geom->geometry_type == ccl::Geometry::MESH) {
+			face_count += static_cast<const ccl::Mesh*>(this_geom)->num_triangles();
+		}
+	}
+
+	*logger << "Unique geometry count: " << scene->geometry.size() << LogCtl::WRITE_LINE;
+	*logger << "Object count: " << scene->objects.size() << LogCtl::WRITE_LINE;
+	*logger << "Face count: " << face_count << LogCtl::WRITE_LINE;
+	*logger << "Light count: " << scene->lights.size() << LogCtl::WRITE_LINE;
+	*logger << "Shader count: " << scene->shaders.size() << LogCtl::WRITE_LINE;
+
+	// Offline renders don't use translators, so the render log is the only place these can be shown
+	std::wstringstream message;
+	message << L"Scene statistics: " << scene->geometry.size() << L" geometry objects, " << scene->objects.size() << L" instances, ";
+	message << face_count << L" faces, " << scene->lights.size() << L" lights, " << scene->shaders.size() << L" shaders";
+	session_context.GetLogger().LogMessage(MaxSDK::RenderingAPI::IRenderingLogger::MessageType::Info, message.str().c_str());
+}
+
+void OfflineTranslationManager::update_texmap_screen_sizes(const std::vector<INode*>& geom_nodes)
+{
+	*logger << "update_texmap_screen_sizes called..." << LogCtl::WRITE_LINE;
+
+	// Smallest bake resolution the heuristic will choose, so distant objects still get a usable texture
+	constexpr int MIN_SCREEN_SIZE_BAKE = 64;
+
+	const boost::optional<CyclesCameraParams> camera_params{ get_camera_params(session_context, frame_t, rend_params.stereo_type) };
+	if (camera_params.has_value() == false || camera_params->camera_type != ccl::CAMERA_PERSPECTIVE) {
+		*logger << "Screen size baking requires a perspective camera, skipping" << LogCtl::WRITE_LINE;
+		return;
+	}
+	const float full_size{ static_cast<float>(std::max(camera_params->final_resolution.x(), camera_params->final_resolution.y())) };
+
+	// Find the largest on-screen size of any object using each material
+	std::map<Mtl*, float> mtl_screen_sizes;
+	for (INode* const node : geom_nodes) {
+		Mtl* const mtl{ node->GetMtl() };
+		if (mtl == nullptr) {
+			continue;
+		}
+
+		const ObjectState os{ node->EvalWorldState(frame_t) };
+		if (os.obj == nullptr) {
+			continue;
+		}
+
+		Matrix3 obj_tm{ node->GetObjTMAfterWSM(frame_t) };
+		Box3 world_bbox;
+		os.obj->GetDeformBBox(frame_t, world_bbox, &obj_tm);
+
+		// Objects without a usable bounding box keep the full bake budget
+		const boost::optional<float> projected_size{ get_projected_size(*camera_params, world_bbox) };
+		const float screen_size{ projected_size ? *projected_size : full_size };
+
+		float& mtl_screen_size{ mtl_screen_sizes[mtl] };
+		mtl_screen_size = std::max(mtl_screen_size, screen_size);
+	}
+
+	// Each texmap is baked at the power of two that covers the largest size of any material it is used by
+	std::map<Texmap*, int> texmap_screen_sizes;
+	for (const auto& this_pair : mtl_screen_sizes) {
+		int bake_size{ MIN_SCREEN_SIZE_BAKE };
+		while (bake_size < this_pair.second) {
+			bake_size *= 2;
+		}
+
+		std::set<Texmap*> texmaps;
+		collect_texmaps(this_pair.first, texmaps);
+		for (Texmap* const this_texmap : texmaps) {
+			int& texmap_screen_size{ texmap_screen_sizes[this_texmap] };
+			texmap_screen_size = std::max(texmap_screen_size, bake_size);
+		}
+	}
+
+	*logger << "Found screen sizes for " << texmap_screen_sizes.size() << " texmaps" << LogCtl::WRITE_LINE;
+
+	texmap_cache.set_texmap_screen_sizes(texmap_screen_sizes);
+}
+
 void OfflineTranslationManager::end_render()
 {
 	*logger << "end_render called..." << LogCtl::WRITE_LINE;
@@ -177,6 +313,8 @@ void OfflineTranslationManager::add_node_to_scene(INode* const node, const std::
 {
 	*logger << "Processing node: " << node->GetName() << LogCtl::WRITE_LINE;
 
+	PerfTraceScope trace_scope{ perf_trace, "node: " + bad_from_wstring(node->GetName()) };
+
 	std::wstring prefix(L"Translating object: ");
 	session_context.GetRenderingProcess().SetRenderingProgressTitle((prefix + node->GetName()).c_str());
 	refresh_ui();
@@ -378,7 +516,10 @@ void OfflineTranslationManager::process_light_object(INode* const node, Object*
 			session_context.GetLogger().LogMessage(MaxSDK::RenderingAPI::IRenderingLogger::MessageType::Error, light_params.error_string.c_str());
 		}
 		else {
-			add_light_to_scene(scene, shader_manager, light_params, rend_params.point_light_size);
+			if (light_params.warning_string.empty() == false) {
+				session_context.GetLogger().LogMessage(MaxSDK::RenderingAPI::IRenderingLogger::MessageType::Warning, light_params.warning_string.c_str());
+			}
+			add_light_to_scene(scene, shader_manager, light_params, rend_params);
 			*logger << "Added" << LogCtl::WRITE_LINE;
 		}
 	}
@@ -406,46 +547,151 @@ void OfflineTranslationManager::process_particle_system(
 
 	const int particle_count{ particle_ext->NumParticles() };
 
+	const std::vector<int> motion_step_ticks{ get_motion_step_ticks(mblur_sample_ticks) };
+	const size_t motion_steps{ motion_step_ticks.size() };
+
+	// Gather the shape and transform of every live particle in a single pass
+	// When motion blur is enabled the transform at every motion step is stored, motion_steps entries per particle
+	std::vector<int> particle_indices;
+	std::vector<Mesh*> particle_shapes;
+	std::vector<ccl::Transform> particle_tfms;
+	std::vector<ccl::Transform> particle_motion_tfms;
+	particle_indices.reserve(particle_count);
+	particle_shapes.reserve(particle_count);
+	particle_tfms.reserve(particle_count);
+	particle_motion_tfms.reserve(particle_count * motion_steps);
 	for (int i{ 0 }; i < particle_count; i++) {
 		if (particle_ext->GetParticleAgeByIndex(i) < 0) {
 			// Particle has not spawned yet
 			continue;
 		}
+		const Matrix3 particle_tm{ *(particle_ext->GetParticleTMByIndex(i)) };
+		particle_indices.push_back(i);
+		particle_shapes.push_back(particle_ext->GetParticleShapeByIndex(i));
+		particle_tfms.push_back(cycles_transform_from_max_matrix(particle_tm));
+		if (motion_steps > 0) {
+			// Speed and spin are both reported per tick, which is what get_particle_motion_tfms expects
+			// Either may be null if the particle system does not track it
+			const Point3* const velocity{ particle_ext->GetParticleSpeedByIndex(i) };
+			const AngAxis* const spin{ particle_ext->GetParticleSpinByIndex(i) };
+			particle_motion_tfms.resize(particle_motion_tfms.size() + motion_steps);
+			get_particle_motion_tfms(
+				particle_tm,
+				velocity ? *velocity : Point3::Origin,
+				spin ? *spin : AngAxis(Point3::ZAxis, 0.0f),
+				motion_step_ticks,
+				particle_motion_tfms.data() + particle_motion_tfms.size() - motion_steps
+			);
+		}
+	}
 
-		ccl::Mesh* ccl_mesh{ nullptr };
+	*logger << "live particles: " << particle_indices.size() << LogCtl::WRITE_LINE;
+
+	refresh_ui();
 
-		Mesh* const this_mesh{ particle_ext->GetParticleShapeByIndex(i) };
+	// These properties are the same for every particle so they only need to be evaluated once
+	CyclesGeomObject geom_object{ get_instance_geom_object(frame_t, node) };
+	const ULONG node_handle{ node->GetHandle() };
+	const ccl::ustring object_name{ bad_from_wstring(node->GetName()) };
+	const ccl::ustring asset_name{ get_asset_name(node) };
 
-		RawMeshDescriptor mesh_desc{ this_mesh, node_mtl, -1 };
-		if (raw_mesh_cache.count(mesh_desc)) {
-			*logger << "Using cached mesh" << LogCtl::WRITE_LINE;
-			ccl_mesh = raw_mesh_cache[mesh_desc];
+	if (get_node_particle_spheres(frame_t, node)) {
+		// Emit the whole system as one sphere cloud, each particle is approximated by the bounding sphere of its shape
+		MaxMultiShaderHelper ms_helper(default_shader);
+		if (node_mtl != nullptr) {
+			ms_helper = shader_manager->get_mtl_multishader(node_mtl);
 		}
-		else {
-			*logger << "Making new mesh..." << LogCtl::WRITE_LINE;
-			const std::shared_ptr<MeshGeometryObj> mesh_geom = get_mesh_geometry(this_mesh, frame_t, mblur_sample_ticks, -1, std::bind(&OfflineTranslationManager::refresh_ui, this));
-			MaxMultiShaderHelper ms_helper(default_shader);
-			if (node_mtl != nullptr) {
-				ms_helper = shader_manager->get_mtl_multishader(node_mtl);
+		ccl::Shader* const sphere_shader{ ms_helper.mesh_shader_vector[ms_helper.get_mesh_index(0)] };
+
+		// Center and radius of each shape's bounding sphere in particle space
+		std::map<Mesh*, std::pair<ccl::float3, float>> shape_bounds;
+
+		std::vector<ccl::float3> centers;
+		std::vector<float> radii;
+		std::vector<float> random_values;
+		std::vector<ccl::float3> motion_centers;
+		centers.reserve(particle_indices.size());
+		radii.reserve(particle_indices.size());
+		random_values.reserve(particle_indices.size());
+		motion_centers.reserve(particle_indices.size() * motion_steps);
+		for (size_t i{ 0 }; i < particle_indices.size(); i++) {
+			Mesh* const this_shape{ particle_shapes[i] };
+			auto this_bounds = shape_bounds.find(this_shape);
+			if (this_bounds == shape_bounds.end()) {
+				std::pair<ccl::float3, float> bounds{ ccl::make_float3(0.0f, 0.0f, 0.0f), 1.0f };
+				if (this_shape != nullptr && this_shape->getNumVerts() > 0) {
+					const Box3 bbox{ this_shape->getBoundingBox() };
+					const Point3 bbox_center{ bbox.Center() };
+					const Point3 bbox_width{ bbox.Width() };
+					bounds.first = ccl::make_float3(bbox_center.x, bbox_center.y, bbox_center.z);
+					bounds.second = 0.5f * std::max(bbox_width.x, std::max(bbox_width.y, bbox_width.z));
+				}
+				this_bounds = shape_bounds.emplace(this_shape, bounds).first;
+			}
+
+			const ccl::Transform& tfm{ particle_tfms[i] };
+			const float scale{ std::max(
+				ccl::len(ccl::transform_get_column(&tfm, 0)),
+				std::max(ccl::len(ccl::transform_get_column(&tfm, 1)), ccl::len(ccl::transform_get_column(&tfm, 2)))
+			) };
+
+			centers.push_back(ccl::transform_point(&tfm, this_bounds->second.first));
+			radii.push_back(this_bounds->second.second * scale);
+			random_values.push_back(ccl::hash_uint_to_float(get_instance_random_id(node_handle, particle_indices[i])));
+			for (size_t step{ 0 }; step < motion_steps; step++) {
+				motion_centers.push_back(ccl::transform_point(&particle_motion_tfms[i * motion_steps + step], this_bounds->second.first));
 			}
-			ccl::Mesh* const new_mesh = get_ccl_mesh(mesh_geom, ms_helper, std::bind(&OfflineTranslationManager::refresh_ui, this));
-			scene->geometry.push_back(new_mesh);
-			raw_mesh_cache[mesh_desc] = new_mesh;
-			ccl_mesh = new_mesh;
-			*logger << "verts: " << mesh_geom->verts.size() << LogCtl::WRITE_LINE;
 		}
 
-		*logger << "Getting object properties..." << LogCtl::WRITE_LINE;
-		const CyclesGeomObject geom_object{ get_geom_object(frame_t, node, particle_ext, i, mblur_sample_ticks) };
+		ccl::Hair* const sphere_cloud{ get_sphere_cloud(centers, radii, random_values, sphere_shader, motion_steps, motion_centers) };
+		scene->geometry.push_back(sphere_cloud);
+
+		geom_object.random_id = get_instance_random_id(node_handle, 0);
+		geom_object.tfm = ccl::transform_identity();
+		geom_object.tfm_pre = geom_object.tfm;
+		geom_object.tfm_post = geom_object.tfm;
 
-		ccl::Object* const new_object{ get_ccl_object(geom_object, ccl_mesh) };
-		new_object->name = bad_from_wstring(node->GetName());
-		new_object->set_asset_name(ccl::ustring(get_asset_name(node)));
+		ccl::Object* const new_object{ get_ccl_object(geom_object, sphere_cloud) };
+		new_object->name = object_name;
+		new_object->set_asset_name(asset_name);
 		scene->objects.push_back(new_object);
 
-		*logger << "Added as " << new_object->name.c_str() << ", " << new_object->get_asset_name().c_str() << LogCtl::WRITE_LINE;
+		*logger << "Added " << centers.size() << " particles as spheres " << object_name.c_str() << ", " << asset_name.c_str() << LogCtl::WRITE_LINE;
+
+		refresh_ui();
+
+		*logger << "Done with particle system" << LogCtl::WRITE_LINE;
+		return;
 	}
 
+	// Particles using the same shape are usually adjacent, so only look up the mesh when the shape changes
+	Mesh* last_shape{ nullptr };
+	ccl::Mesh* last_ccl_mesh{ nullptr };
+
+	scene->objects.reserve(scene->objects.size() + particle_indices.size());
+	for (size_t i{ 0 }; i < particle_indices.size(); i++) {
+		if (particle_shapes[i] != last_shape || last_ccl_mesh == nullptr) {
+			last_shape = particle_shapes[i];
+			last_ccl_mesh = get_raw_mesh(last_shape, node_mtl, -1, default_shader, mblur_sample_ticks);
+		}
+
+		geom_object.random_id = get_instance_random_id(node_handle, particle_indices[i]);
+		geom_object.tfm = particle_tfms[i];
+		geom_object.tfm_pre = geom_object.tfm;
+		geom_object.tfm_post = geom_object.tfm;
+		if (motion_steps > 0) {
+			const auto this_motion_begin = particle_motion_tfms.begin() + i * motion_steps;
+			geom_object.motion_tfms.assign(this_motion_begin, this_motion_begin + motion_steps);
+		}
+
+		ccl::Object* const new_object{ get_ccl_object(geom_object, last_ccl_mesh) };
+		new_object->name = object_name;
+		new_object->set_asset_name(asset_name);
+		scene->objects.push_back(new_object);
+	}
+
+	*logger << "Added " << particle_indices.size() << " particles as " << object_name.c_str() << ", " << asset_name.c_str() << LogCtl::WRITE_LINE;
+
 	refresh_ui();
 	
 	*logger << "Done with particle system" << LogCtl::WRITE_LINE;
@@ -463,82 +709,96 @@ void OfflineTranslationManager::process_particle_system_ty(
 	const ccl::float3 wire_color{ get_float3_from_colorref(node->GetWireColor()) };
 	ccl::Shader* const default_shader{ scene->shaders[shader_manager->get_simple_color_shader(wire_color)] };
 
-	ty_ext->UpdateTyParticles(node, frame_t, tyParticleObjectExt2::plugin_arnold);
+	// tm0 and tm1 of each instance hold its transform at the start and end of this interval
+	const std::vector<int> motion_step_ticks{ get_motion_step_ticks(mblur_sample_ticks) };
+	const size_t motion_steps{ motion_step_ticks.size() };
+	const TimeValue shutter_open{ motion_steps > 0 ? frame_t + motion_step_ticks.front() : frame_t };
+	const TimeValue shutter_close{ motion_steps > 0 ? frame_t + motion_step_ticks.back() : frame_t };
+
+	// CollectInstances updates the particles itself, so there is no need to call UpdateTyParticles first
+	const std::vector<tyInstanceInfo> instances = ty_ext->CollectInstances(node, shutter_open, shutter_close, TYFLOW_PLUGIN_ID);
+
+	// These properties are the same for every instance so they only need to be evaluated once
+	CyclesGeomObject geom_object{ get_instance_geom_object(frame_t, node) };
+	const ULONG node_handle{ node->GetHandle() };
+	const ccl::ustring object_name{ bad_from_wstring(node->GetName()) };
+	const ccl::ustring asset_name{ get_asset_name(node) };
 
-	std::vector<tyInstanceInfo> instances = ty_ext->CollectInstances(node, frame_t, frame_t, tyParticleObjectExt2::plugin_arnold);
+	size_t total_instances{ 0 };
 	for (const tyInstanceInfo& instance_info : instances) {
-		ccl::Mesh* ccl_mesh = nullptr;
+		total_instances += instance_info.instances.size();
+	}
+	scene->objects.reserve(scene->objects.size() + total_instances);
 
+	for (const tyInstanceInfo& instance_info : instances) {
 		*logger << "found " << instance_info.instances.size() << " instances for this mesh" << LogCtl::WRITE_LINE;
+
+		// Group instances by their overrides so each combination only needs a single mesh and shader lookup
+		std::map<std::pair<Mtl*, int>, std::vector<const tyInstance*>> instance_groups;
 		for (const tyInstance& this_instance : instance_info.instances) {
 			Mtl* const this_mtl = this_instance.materialOverride ? this_instance.materialOverride : node_mtl;
-			RawMeshDescriptor mesh_desc{ instance_info.mesh, this_mtl, this_instance.matIDOverride };
-			if (raw_mesh_cache.count(mesh_desc)) {
-				*logger << "Using cached mesh" << LogCtl::WRITE_LINE;
-				ccl_mesh = raw_mesh_cache[mesh_desc];
-			}
-			else {
-				*logger << "Making new mesh..." << LogCtl::WRITE_LINE;
-				const std::shared_ptr<MeshGeometryObj> mesh_geom = get_mesh_geometry(instance_info.mesh, frame_t, mblur_sample_ticks, this_instance.matIDOverride, std::bind(&OfflineTranslationManager::refresh_ui, this));
-				MaxMultiShaderHelper ms_helper(default_shader);
-				if (this_mtl != nullptr) {
-					ms_helper = shader_manager->get_mtl_multishader(this_mtl);
-				}
-				ccl::Mesh* const new_mesh = get_ccl_mesh(mesh_geom, ms_helper, std::bind(&OfflineTranslationManager::refresh_ui, this));
-				scene->geometry.push_back(new_mesh);
-				raw_mesh_cache[mesh_desc] = new_mesh;
-				ccl_mesh = new_mesh;
-				*logger << "verts: " << mesh_geom->verts.size() << LogCtl::WRITE_LINE;
-			}
-
-			*logger << "Getting object properties..." << LogCtl::WRITE_LINE;
-
-			// Assemble a GeomObject ourselves for this special case
-			CyclesGeomObject geom_object;
+			instance_groups[std::make_pair(this_mtl, this_instance.matIDOverride)].push_back(&this_instance);
+		}
 
-			// Set up random value based on INode handle
-			// This is used for the "random" output of the object info node
-			{
-				std::mt19937 rng;
-				const unsigned long seed = node->GetHandle() + static_cast<unsigned long>(this_instance.ID);
-				rng.seed(seed);
-				geom_object.random_id = rng();
-			}
+		*logger << "instance groups: " << instance_groups.size() << LogCtl::WRITE_LINE;
 
-			if (mblur_sample_ticks.size() > 0) {
-				geom_object.use_object_motion_blur = true;
-				geom_object.tfm = cycles_transform_from_max_matrix(this_instance.tm0);
+		for (const auto& group : instance_groups) {
+			Mtl* const group_mtl = group.first.first;
+			const int group_mtl_id_override = group.first.second;
+			ccl::Mesh* const ccl_mesh = get_raw_mesh(instance_info.mesh, group_mtl, group_mtl_id_override, default_shader, mblur_sample_ticks);
 
-				const float pre_scale = static_cast<float>(mblur_sample_ticks[0]) / static_cast<float>(GetTicksPerFrame());
-				Matrix3 pre_transform = this_instance.tm0;
-				pre_transform.SetTrans(pre_transform.GetTrans() + this_instance.vel * pre_scale);
+			for (const tyInstance* const this_instance : group.second) {
+				geom_object.random_id = get_instance_random_id(node_handle, static_cast<int>(this_instance->ID));
 
-				const float post_scale = static_cast<float>(mblur_sample_ticks[mblur_sample_ticks.size() - 1]) / static_cast<float>(GetTicksPerFrame());
-				Matrix3 post_transform = this_instance.tm0;
-				post_transform.SetTrans(post_transform.GetTrans() + this_instance.vel * post_scale);
+				if (motion_steps > 0) {
+					geom_object.motion_tfms.resize(motion_steps);
+					get_interpolated_motion_tfms(this_instance->tm0, this_instance->tm1, motion_steps, geom_object.motion_tfms.data());
+					geom_object.tfm = geom_object.motion_tfms[motion_steps / 2];
+				}
+				else {
+					geom_object.tfm = cycles_transform_from_max_matrix(this_instance->tm0);
+				}
 
-				geom_object.tfm_pre = cycles_transform_from_max_matrix(pre_transform);
-				geom_object.tfm_post = cycles_transform_from_max_matrix(post_transform);
-			}
-			else {
-				geom_object.tfm = cycles_transform_from_max_matrix(this_instance.tm0);
+				ccl::Object* const new_object{ get_ccl_object(geom_object, ccl_mesh) };
+				new_object->name = object_name;
+				new_object->set_asset_name(asset_name);
+				scene->objects.push_back(new_object);
 			}
+		}
 
-			geom_object.is_shadow_catcher = false;
-			geom_object.visible_to_camera = node->GetPrimaryVisibility();
+		refresh_ui();
+	}
 
-			ccl::Object* const new_object{ get_ccl_object(geom_object, ccl_mesh) };
-			new_object->name = bad_from_wstring(node->GetName());
-			new_object->set_asset_name(ccl::ustring(get_asset_name(node)));
-			scene->objects.push_back(new_object);
+	*logger << "Added " << total_instances << " instances as " << object_name.c_str() << ", " << asset_name.c_str() << LogCtl::WRITE_LINE;
 
-			*logger << "Added as " << new_object->name.c_str() << ", " << new_object->get_asset_name().c_str() << LogCtl::WRITE_LINE;
-		}
+	*logger << "Done with tyFlow system" << LogCtl::WRITE_LINE;
+}
+
+ccl::Mesh* OfflineTranslationManager::get_raw_mesh(
+	Mesh* const mesh,
+	Mtl* const mtl,
+	const int mtl_id_override,
+	ccl::Shader* const default_shader,
+	const std::vector<int>& mblur_sample_ticks)
+{
+	const RawMeshDescriptor mesh_desc{ mesh, mtl, mtl_id_override };
+	const auto cached_mesh = raw_mesh_cache.find(mesh_desc);
+	if (cached_mesh != raw_mesh_cache.end()) {
+		return cached_mesh->second;
 	}
 
-	refresh_ui();
+	*logger << "Making new mesh..." << LogCtl::WRITE_LINE;
+	const std::shared_ptr<MeshGeometryObj> mesh_geom = get_mesh_geometry(mesh, frame_t, mblur_sample_ticks, mtl_id_override, std::bind(&OfflineTranslationManager::refresh_ui, this));
+	MaxMultiShaderHelper ms_helper(default_shader);
+	if (mtl != nullptr) {
+		ms_helper = shader_manager->get_mtl_multishader(mtl);
+	}
+	ccl::Mesh* const new_mesh = get_ccl_mesh(mesh_geom, ms_helper, std::bind(&OfflineTranslationManager::refresh_ui, this));
+	scene->geometry.push_back(new_mesh);
+	raw_mesh_cache[mesh_desc] = new_mesh;
+	*logger << "verts: " << mesh_geom->verts.size() << LogCtl::WRITE_LINE;
 
-	*logger << "Done with tyFlow system" << LogCtl::WRITE_LINE;
+	return new_mesh;
 }
 
 void OfflineTranslationManager::refresh_ui()
@@ -36,6 +36,7 @@
 
 class BakedTexmapCache;
 class CyclesRenderParams;
+class FramePerfTrace;
 class GeomObject;
 class Mesh;
 class Mtl;
@@ -48,6 +49,7 @@ namespace ccl {
 	class DeviceInfo;
 	class Mesh;
 	class Scene;
+	class Shader;
 }
 
 namespace MaxSDK {
@@ -66,7 +68,8 @@ public:
 	OfflineTranslationManager(
 		MaxSDK::RenderingAPI::IRenderSessionContext& session_context,
 		BakedTexmapCache& texmap_cache,
-		CyclesRenderParams& rend_params
+		CyclesRenderParams& rend_params,
+		FramePerfTrace* perf_trace = nullptr
 	);
 
 	// Create the scene object to be populated
@@ -85,10 +88,18 @@ private:
 	std::unique_ptr<MaxShaderManager> shader_manager;
 	BakedTexmapCache& texmap_cache;
 
+	FramePerfTrace* const perf_trace;
+
 	std::atomic<bool> stop_requested = false;
 
 	void add_node_to_scene(INode* node, const std::vector<int>& mblur_sample_ticks);
 
+	// Writes object, face, light and shader counts for the translated scene to the plugin and render logs
+	void log_scene_statistics();
+
+	// Estimates how large each material appears on screen and passes the result to the texmap cache
+	void update_texmap_screen_sizes(const std::vector<INode*>& geom_nodes);
+
 	void add_mtl_preview_lights_new();
 	void add_mtl_preview_lights();
 
@@ -97,6 +108,8 @@ private:
 	void process_particle_system(INode* node, IParticleObjectExt* particle_ext, const std::vector<int>& mblur_sample_ticks);
 	void process_particle_system_ty(INode* node, tyParticleInterface* ty_ext, const std::vector<int>& mblur_sample_ticks);
 
+	// Returns the ccl::Mesh for a raw Mesh used by particles, creating it if it does not yet exist
+	ccl::Mesh* get_raw_mesh(Mesh* mesh, Mtl* mtl, int mtl_id_override, ccl::Shader* default_shader, const std::vector<int>& mblur_sample_ticks);
 
 	void refresh_ui();
 
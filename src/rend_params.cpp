@@ -93,8 +93,12 @@ void CyclesRenderParams::SetDefaults()
 	bg_intensity = default_params.bg_intensity;
 	mis_map_size = default_params.mis_map_size;
 	point_light_size = default_params.point_light_size;
+	light_use_mis = default_params.light_use_mis;
+	auto_emission_mis = default_params.auto_emission_mis;
+	auto_emission_mis_threshold = default_params.auto_emission_mis_threshold;
 	texmap_bake_width = default_params.texmap_bake_width;
 	texmap_bake_height = default_params.texmap_bake_height;
+	texmap_bake_screen_size = default_params.texmap_bake_screen_size;
 	deform_blur_samples = default_params.deform_blur_samples;
 
 	lp_max_bounce = default_params.lp_max_bounce;
@@ -114,6 +118,7 @@ void CyclesRenderParams::SetDefaults()
 	tile_height = default_params.tile_height;
 	use_progressive_refine = default_params.use_progressive_refine;
 	cpu_threads = default_params.cpu_threads;
+	activeshade_start_divider = default_params.activeshade_start_divider;
 
 	stereo_type = default_params.stereo_type;
 	interocular_distance = default_params.interocular_distance;
@@ -127,6 +132,8 @@ void CyclesRenderParams::SetDefaults()
 
 	diagnostic_log = default_params.diagnostic_log;
 	debug_multi_cuda = default_params.debug_multi_cuda;
+	perf_trace_format = default_params.perf_trace_format;
+	write_scene_snapshot = default_params.write_scene_snapshot;
 }
 
 void CyclesRenderParams::SetMtlEditParams()
@@ -236,7 +243,11 @@ IOResult CyclesRenderParams::LoadChunks(ILoad& iload)
 	// Translation
 	load_chunk_value<float>(chunk_map, BG_INTENSITY_CHUNK, bg_intensity);
 	load_chunk_value<float>(chunk_map, POINT_LIGHT_SIZE_CHUNK, point_light_size);
+	load_chunk_value<bool> (chunk_map, LIGHT_USE_MIS_CHUNK, light_use_mis);
+	load_chunk_value<bool> (chunk_map, AUTO_EMISSION_MIS_CHUNK, auto_emission_mis);
+	load_chunk_value<float>(chunk_map, AUTO_EMISSION_MIS_THRESHOLD_CHUNK, auto_emission_mis_threshold);
 	load_chunk_value<int>  (chunk_map, DEFORM_BLUR_SAMPLES_CHUNK, deform_blur_samples);
+	load_chunk_value<bool> (chunk_map, TEXMAP_BAKE_SCREEN_SIZE_CHUNK, texmap_bake_screen_size);
 	if (file_compat_level >= 2) {
 		// If compat level is below 2, this might be corrupt
 		load_chunk_value<int>(chunk_map, MIS_MAP_SIZE_CHUNK, mis_map_size);
@@ -264,6 +275,7 @@ IOResult CyclesRenderParams::LoadChunks(ILoad& iload)
 	load_chunk_value<int> (chunk_map, TILE_HEIGHT_CHUNK, tile_height);
 	load_chunk_value<bool>(chunk_map, USE_PROGRESSIVE_REFINE_CHUNK, use_progressive_refine);
 	load_chunk_value<int> (chunk_map, PERF_CPU_THREADS_CHUNK, cpu_threads);
+	load_chunk_value<int> (chunk_map, PERF_ACTIVESHADE_START_DIVIDER_CHUNK, activeshade_start_divider);
 
 	// Stereoscopy
 	load_chunk_value_enum<StereoscopyType>(chunk_map, STEREO_TYPE_CHUNK, stereo_type);
@@ -280,6 +292,10 @@ IOResult CyclesRenderParams::LoadChunks(ILoad& iload)
 		load_chunk_value<float>(chunk_map, PASS_MIST_EXPONENT_CHUNK, mist_exponent);
 	}
 
+	// Debug
+	load_chunk_value_enum<PerfTraceFormat>(chunk_map, DEBUG_PERF_TRACE_FORMAT_CHUNK, perf_trace_format);
+	load_chunk_value<bool>(chunk_map, DEBUG_WRITE_SCENE_SNAPSHOT_CHUNK, write_scene_snapshot);
+
 	// Defaults for new parameters - special case
 	// Each line here should have an explanation of what it does
 
@@ -381,6 +397,15 @@ IOResult CyclesRenderParams::SaveChunks(ISave& isave) const
 	isave.BeginChunk(POINT_LIGHT_SIZE_CHUNK);
 	isave.Write(&point_light_size, sizeof(float), &nb);
 	isave.EndChunk();
+	isave.BeginChunk(LIGHT_USE_MIS_CHUNK);
+	isave.Write(&light_use_mis, sizeof(bool), &nb);
+	isave.EndChunk();
+	isave.BeginChunk(AUTO_EMISSION_MIS_CHUNK);
+	isave.Write(&auto_emission_mis, sizeof(bool), &nb);
+	isave.EndChunk();
+	isave.BeginChunk(AUTO_EMISSION_MIS_THRESHOLD_CHUNK);
+	isave.Write(&auto_emission_mis_threshold, sizeof(float), &nb);
+	isave.EndChunk();
 	isave.BeginChunk(TEXMAP_BAKE_WIDTH_CHUNK);
 	isave.Write(&texmap_bake_width, sizeof(int), &nb);
 	isave.EndChunk();
@@ -390,6 +415,9 @@ IOResult CyclesRenderParams::SaveChunks(ISave& isave) const
 	isave.BeginChunk(DEFORM_BLUR_SAMPLES_CHUNK);
 	isave.Write(&deform_blur_samples, sizeof(int), &nb);
 	isave.EndChunk();
+	isave.BeginChunk(TEXMAP_BAKE_SCREEN_SIZE_CHUNK);
+	isave.Write(&texmap_bake_screen_size, sizeof(bool), &nb);
+	isave.EndChunk();
 
 	isave.BeginChunk(TRANSPARENT_SKY_CHUNK);
 	isave.Write(&use_transparent_sky, sizeof(bool), &nb);
@@ -417,6 +445,9 @@ IOResult CyclesRenderParams::SaveChunks(ISave& isave) const
 	isave.BeginChunk(PERF_CPU_THREADS_CHUNK);
 	isave.Write(&cpu_threads, sizeof(int), &nb);
 	isave.EndChunk();
+	isave.BeginChunk(PERF_ACTIVESHADE_START_DIVIDER_CHUNK);
+	isave.Write(&activeshade_start_divider, sizeof(int), &nb);
+	isave.EndChunk();
 
 
 	isave.BeginChunk(LP_MAX_BOUNCE_CHUNK);
@@ -469,5 +500,13 @@ IOResult CyclesRenderParams::SaveChunks(ISave& isave) const
 	isave.Write(&mist_exponent, sizeof(float), &nb);
 	isave.EndChunk();
 
+	isave.BeginChunk(DEBUG_PERF_TRACE_FORMAT_CHUNK);
+	const int perf_trace_format_int = static_cast<int>(perf_trace_format);
+	isave.Write(&perf_trace_format_int, sizeof(int), &nb);
+	isave.EndChunk();
+	isave.BeginChunk(DEBUG_WRITE_SCENE_SNAPSHOT_CHUNK);
+	isave.Write(&write_scene_snapshot, sizeof(bool), &nb);
+	isave.EndChunk();
+
 	return IO_OK;
 }
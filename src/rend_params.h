@@ -64,8 +64,12 @@ public:
 	float bg_intensity = 1.0f;
 	int mis_map_size = 2048;
 	float point_light_size = 0.394f;
+	bool light_use_mis = false;
+	bool auto_emission_mis = false;
+	float auto_emission_mis_threshold = 1.0f;
 	int texmap_bake_width = 512;
 	int texmap_bake_height = 512;
+	bool texmap_bake_screen_size = false;
 	int deform_blur_samples = 1;
 
 	// Light path
@@ -88,6 +92,8 @@ public:
 	int tile_height = 80;
 	bool use_progressive_refine = true;
 	int cpu_threads = 0;
+	// ActiveShade starts at 1/divider resolution and doubles each pass until full resolution, 1 disables this
+	int activeshade_start_divider = 1;
 
 	// Stereoscopy
 	StereoscopyType stereo_type = StereoscopyType::NONE;
@@ -104,6 +110,8 @@ public:
 	// Debug
 	bool diagnostic_log = false;
 	bool debug_multi_cuda = false;
+	PerfTraceFormat perf_trace_format = PerfTraceFormat::NONE;
+	bool write_scene_snapshot = false;
 
 	//////
 	// Standard options
@@ -172,6 +180,10 @@ private:
 	static const USHORT TEXMAP_BAKE_WIDTH_CHUNK = 7001;
 	static const USHORT TEXMAP_BAKE_HEIGHT_CHUNK = 7002;
 	static const USHORT DEFORM_BLUR_SAMPLES_CHUNK = 7005;
+	static const USHORT TEXMAP_BAKE_SCREEN_SIZE_CHUNK = 7006;
+	static const USHORT LIGHT_USE_MIS_CHUNK = 7007;
+	static const USHORT AUTO_EMISSION_MIS_CHUNK = 7008;
+	static const USHORT AUTO_EMISSION_MIS_THRESHOLD_CHUNK = 7009;
 
 	static const USHORT TRANSPARENT_SKY_CHUNK = 3001;
 	static const USHORT EXPOSURE_CHUNK = 3002;
@@ -182,6 +194,7 @@ private:
 	static const USHORT TILE_HEIGHT_CHUNK = 4002;
 	static const USHORT USE_PROGRESSIVE_REFINE_CHUNK = 4003;
 	static const USHORT PERF_CPU_THREADS_CHUNK = 4008;
+	static const USHORT PERF_ACTIVESHADE_START_DIVIDER_CHUNK = 4009;
 
 	static const USHORT LP_MAX_BOUNCE_CHUNK = 5001;
 	static const USHORT LP_MIN_BOUNCE_CHUNK = 5002;
@@ -201,6 +214,9 @@ private:
 	static const USHORT PASS_MIST_DEPTH_CHUNK = 8002;
 	static const USHORT PASS_MIST_EXPONENT_CHUNK = 8003;
 
+	static const USHORT DEBUG_PERF_TRACE_FORMAT_CHUNK = 9001;
+	static const USHORT DEBUG_WRITE_SCENE_SNAPSHOT_CHUNK = 9002;
+
 	// Old parameters that are now read-only for compatibility
 	static const USHORT CUDA_DEVICE_032_CHUNK = 1005;
 
@@ -0,0 +1,156 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#include "rend_perf_trace.h"
+
+#include <fstream>
+
+#include "util_windows.h"
+
+static std::string escape_json_string(const std::string& input)
+{
+	std::string result;
+	result.reserve(input.size());
+	for (const char this_char : input) {
+		if (this_char == '"' || this_char == '\\') {
+			result.push_back('\\');
+			result.push_back(this_char);
+		}
+		else if (static_cast<unsigned char>(this_char) < 0x20) {
+			result.push_back(' ');
+		}
+		else {
+			result.push_back(this_char);
+		}
+	}
+	return result;
+}
+
+static std::string escape_csv_string(const std::string& input)
+{
+	std::string result{ "\"" };
+	for (const char this_char : input) {
+		if (this_char == '"') {
+			result.push_back('"');
+		}
+		result.push_back(this_char);
+	}
+	result.push_back('"');
+	return result;
+}
+
+FramePerfTrace::FramePerfTrace() : trace_begin_time{ std::chrono::steady_clock::now() }
+{
+
+}
+
+void FramePerfTrace::begin_phase(const std::string& name)
+{
+	Phase new_phase;
+	new_phase.name = name;
+	new_phase.depth = static_cast<int>(open_phases.size());
+	new_phase.begin_us = get_us_since_begin(std::chrono::steady_clock::now());
+	new_phase.memory_begin = get_memory_usage();
+
+	open_phases.push_back(phases.size());
+	phases.push_back(new_phase);
+}
+
+void FramePerfTrace::end_phase()
+{
+	if (open_phases.empty()) {
+		return;
+	}
+
+	Phase& this_phase = phases[open_phases.back()];
+	open_phases.pop_back();
+
+	this_phase.duration_us = get_us_since_begin(std::chrono::steady_clock::now()) - this_phase.begin_us;
+	this_phase.memory_end = get_memory_usage();
+}
+
+void FramePerfTrace::add_phase(const std::string& name, const std::chrono::steady_clock::time_point begin_time, const double duration_seconds, const size_t device_memory_peak)
+{
+	Phase new_phase;
+	new_phase.name = name;
+	new_phase.depth = static_cast<int>(open_phases.size());
+	new_phase.begin_us = get_us_since_begin(begin_time);
+	new_phase.duration_us = static_cast<long long>(duration_seconds * 1000000.0);
+	new_phase.device_memory_peak = device_memory_peak;
+
+	phases.push_back(new_phase);
+}
+
+bool FramePerfTrace::write_chrome_json(const std::wstring& path) const
+{
+	std::ofstream out_file(path, std::ofstream::trunc);
+	if (out_file.is_open() == false) {
+		return false;
+	}
+
+	out_file << "{\"traceEvents\":[\n";
+	for (size_t i = 0; i < phases.size(); ++i) {
+		const Phase& this_phase = phases[i];
+		out_file << "{\"name\":\"" << escape_json_string(this_phase.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1";
+		out_file << ",\"ts\":" << this_phase.begin_us << ",\"dur\":" << this_phase.duration_us;
+		out_file << ",\"args\":{\"memory_begin_bytes\":" << this_phase.memory_begin << ",\"memory_end_bytes\":" << this_phase.memory_end;
+		out_file << ",\"device_memory_peak_bytes\":" << this_phase.device_memory_peak << "}}";
+		if (i + 1 < phases.size()) {
+			out_file << ",";
+		}
+		out_file << "\n";
+	}
+	out_file << "],\"displayTimeUnit\":\"ms\"}\n";
+
+	return out_file.good();
+}
+
+bool FramePerfTrace::write_csv(const std::wstring& path) const
+{
+	std::ofstream out_file(path, std::ofstream::trunc);
+	if (out_file.is_open() == false) {
+		return false;
+	}
+
+	out_file << "phase,depth,begin_us,duration_us,memory_begin_bytes,memory_end_bytes,device_memory_peak_bytes\n";
+	for (const Phase& this_phase : phases) {
+		out_file << escape_csv_string(this_phase.name) << "," << this_phase.depth << ",";
+		out_file << this_phase.begin_us << "," << this_phase.duration_us << ",";
+		out_file << this_phase.memory_begin << "," << this_phase.memory_end << "," << this_phase.device_memory_peak << "\n";
+	}
+
+	return out_file.good();
+}
+
+long long FramePerfTrace::get_us_since_begin(const std::chrono::steady_clock::time_point time) const
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(time - trace_begin_time).count();
+}
+
+PerfTraceScope::PerfTraceScope(FramePerfTrace* const trace, const std::string& name) : trace{ trace }
+{
+	if (trace != nullptr) {
+		trace->begin_phase(name);
+	}
+}
+
+PerfTraceScope::~PerfTraceScope()
+{
+	if (trace != nullptr) {
+		trace->end_phase();
+	}
+}
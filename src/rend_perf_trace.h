@@ -0,0 +1,84 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#pragma once
+
+/**
+ * @file
+ * @brief Defines FramePerfTrace and PerfTraceScope.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Class that records wall time and memory usage for each phase of an offline frame.
+ *
+ * Host memory is the process working set when each phase begins and ends. Phases may be nested. All phases must be
+ * recorded from a single thread.
+ */
+class FramePerfTrace {
+public:
+	FramePerfTrace();
+
+	void begin_phase(const std::string& name);
+	void end_phase();
+
+	// Records a phase that was timed elsewhere, such as by the Cycles progress object
+	// Host memory is not known at the start of these phases so it is not recorded, device_memory_peak may be 0 if unknown
+	void add_phase(const std::string& name, std::chrono::steady_clock::time_point begin_time, double duration_seconds, size_t device_memory_peak = 0);
+
+	// Writes all phases in the Chrome trace event format, which can be opened with chrome://tracing
+	bool write_chrome_json(const std::wstring& path) const;
+	bool write_csv(const std::wstring& path) const;
+
+private:
+	class Phase {
+	public:
+		std::string name;
+		int depth = 0;
+		long long begin_us = 0;
+		long long duration_us = 0;
+		size_t memory_begin = 0;
+		size_t memory_end = 0;
+		size_t device_memory_peak = 0;
+	};
+
+	const std::chrono::steady_clock::time_point trace_begin_time;
+
+	std::vector<Phase> phases;
+	std::vector<size_t> open_phases;
+
+	long long get_us_since_begin(std::chrono::steady_clock::time_point time) const;
+};
+
+/**
+ * @brief Records a phase in a FramePerfTrace for as long as this object exists, does nothing if trace is null.
+ */
+class PerfTraceScope {
+public:
+	PerfTraceScope(FramePerfTrace* trace, const std::string& name);
+	~PerfTraceScope();
+
+	PerfTraceScope(const PerfTraceScope&) = delete;
+	PerfTraceScope& operator=(const PerfTraceScope&) = delete;
+
+private:
+	FramePerfTrace* const trace;
+};
@@ -0,0 +1,543 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#include "rend_scene_snapshot.h"
+
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include <graph/node_xml.h>
+#include <render/background.h>
+#include <render/camera.h>
+#include <render/film.h>
+#include <render/graph.h>
+#include <render/integrator.h>
+#include <render/light.h>
+#include <render/mesh.h>
+#include <render/nodes.h>
+#include <render/object.h>
+#include <render/scene.h>
+#include <render/shader.h>
+#include <util/util_math.h>
+#include <util/util_xml.h>
+
+#include <OpenImageIO/imageio.h>
+
+#include "cache_baked_texmap.h"
+#include "cycles_image.h"
+#include "util_windows.h"
+
+// Increment this whenever the layout of the written file changes
+static const int SNAPSHOT_FORMAT_VERSION = 2;
+
+/**
+ * @brief Writes each baked image used by a snapshot once and remembers the file it was written to.
+ */
+class SnapshotImageWriter {
+public:
+	SnapshotImageWriter(const BakedTexmapCache& texmap_cache, const std::string& dir, const std::string& name_prefix) :
+		texmap_cache(texmap_cache),
+		dir(dir),
+		name_prefix(name_prefix)
+	{
+
+	}
+
+	// Returns the path of the written image relative to the snapshot, or an empty string if the image is not baked
+	std::string get_image_path(const std::string& filename)
+	{
+		if (written_images.count(filename) == 1) {
+			return written_images[filename];
+		}
+
+		SampledImage sampled_image;
+		if (texmap_cache.get_sampled_image(filename, sampled_image) == false) {
+			return std::string();
+		}
+
+		const bool use_float = sampled_image.float_pixels.get() != nullptr;
+		const std::string relative_path = name_prefix + "_img" + std::to_string(written_images.size()) + (use_float ? ".exr" : ".png");
+		if (write_image(sampled_image, dir + relative_path) == false) {
+			return std::string();
+		}
+
+		written_images[filename] = relative_path;
+		return relative_path;
+	}
+
+	size_t get_written_count() const
+	{
+		return written_images.size();
+	}
+
+private:
+	const BakedTexmapCache& texmap_cache;
+	const std::string dir;
+	const std::string name_prefix;
+
+	std::map<std::string, std::string> written_images;
+
+	static bool write_image(const SampledImage& sampled_image, const std::string& path)
+	{
+		const bool use_float = sampled_image.float_pixels.get() != nullptr;
+		const unsigned char* const pixels = use_float ?
+			reinterpret_cast<const unsigned char*>(sampled_image.float_pixels.get()) :
+			sampled_image.char_pixels.get();
+		if (pixels == nullptr || sampled_image.width == 0 || sampled_image.height == 0) {
+			return false;
+		}
+
+		auto image_output = OIIO::ImageOutput::create(path);
+		if (!image_output) {
+			return false;
+		}
+
+		constexpr int CHANNELS = 4;
+		const OIIO::TypeDesc type = use_float ? OIIO::TypeDesc::FLOAT : OIIO::TypeDesc::UINT8;
+		const OIIO::ImageSpec spec(static_cast<int>(sampled_image.width), static_cast<int>(sampled_image.height), CHANNELS, type);
+		if (image_output->open(path, spec) == false) {
+			return false;
+		}
+
+		// Cycles stores images with the bottom row first, write them flipped so they load back in the same order
+		const ptrdiff_t scanline_size = static_cast<ptrdiff_t>(sampled_image.width * CHANNELS * type.size());
+		const unsigned char* const last_scanline = pixels + (sampled_image.height - 1) * scanline_size;
+		const bool result = image_output->write_image(type, last_scanline, OIIO::AutoStride, -scanline_size, OIIO::AutoStride);
+		image_output->close();
+
+		return result;
+	}
+};
+
+static std::string get_float_stream_string(const std::vector<float>& values)
+{
+	std::stringstream result;
+	result << std::setprecision(std::numeric_limits<float>::max_digits10);
+	for (size_t i = 0; i < values.size(); ++i) {
+		if (i > 0) {
+			result << ' ';
+		}
+		result << values[i];
+	}
+	return result.str();
+}
+
+static std::string get_int_stream_string(const std::vector<int>& values)
+{
+	std::stringstream result;
+	for (size_t i = 0; i < values.size(); ++i) {
+		if (i > 0) {
+			result << ' ';
+		}
+		result << values[i];
+	}
+	return result.str();
+}
+
+static std::string get_matrix_string(const ccl::Transform& tfm)
+{
+	const ccl::float4 rows[4] = { tfm.x, tfm.y, tfm.z, ccl::make_float4(0.0f, 0.0f, 0.0f, 1.0f) };
+
+	// The standalone reader transposes this matrix after loading it, so it is written one column at a time
+	std::vector<float> values;
+	for (int col = 0; col < 4; ++col) {
+		for (int row = 0; row < 4; ++row) {
+			values.push_back(rows[row][col]);
+		}
+	}
+	return get_float_stream_string(values);
+}
+
+static void set_xml_attribute(ccl::xml_node node, const char* const name, const std::string& value)
+{
+	ccl::xml_attribute attribute = node.attribute(name);
+	if (!attribute) {
+		attribute = node.append_attribute(name);
+	}
+	attribute.set_value(value.c_str());
+}
+
+static void write_shader_graph(ccl::ShaderGraph* const graph, ccl::xml_node parent, SnapshotImageWriter& image_writer)
+{
+	// The standalone reader creates the output node itself and refers to it as "output"
+	std::map<const ccl::ShaderNode*, std::string> node_names;
+	node_names[graph->output()] = "output";
+
+	for (ccl::ShaderNode* const this_node : graph->nodes) {
+		if (this_node == graph->output()) {
+			continue;
+		}
+
+		const std::string node_name = "node" + std::to_string(node_names.size());
+		node_names[this_node] = node_name;
+
+		ccl::xml_node xml_node = ccl::xml_write_node(this_node, parent);
+		set_xml_attribute(xml_node, "name", node_name);
+
+		// Baked texmaps only exist in memory, point the node at a copy written next to the snapshot instead
+		std::string filename;
+		if (const ccl::ImageTextureNode* const image_node = dynamic_cast<const ccl::ImageTextureNode*>(this_node)) {
+			filename = image_node->get_filename().string();
+		}
+		else if (const ccl::EnvironmentTextureNode* const env_node = dynamic_cast<const ccl::EnvironmentTextureNode*>(this_node)) {
+			filename = env_node->get_filename().string();
+		}
+		if (filename.empty() == false) {
+			const std::string image_path = image_writer.get_image_path(filename);
+			if (image_path.empty() == false) {
+				set_xml_attribute(xml_node, "filename", image_path);
+			}
+		}
+	}
+
+	for (ccl::ShaderNode* const this_node : graph->nodes) {
+		for (ccl::ShaderInput* const this_input : this_node->inputs) {
+			if (this_input->link == nullptr) {
+				continue;
+			}
+
+			ccl::xml_node connect_node = parent.append_child("connect");
+			// Sockets are referred to by their internal names as the display names may contain spaces
+			const std::string from = node_names[this_input->link->parent] + " " + this_input->link->socket_type.name.string();
+			const std::string to = node_names[this_node] + " " + this_input->socket_type.name.string();
+			connect_node.append_attribute("from") = from.c_str();
+			connect_node.append_attribute("to") = to.c_str();
+		}
+	}
+}
+
+// The standalone format applies a single shader and smoothing mode to each mesh element, so triangles are grouped by both
+static std::map<std::pair<int, bool>, std::vector<size_t>> get_triangle_groups(const ccl::Mesh* const mesh)
+{
+	const ccl::array<int>& tri_shaders = mesh->get_shader();
+	const ccl::array<bool>& tri_smooth = mesh->get_smooth();
+
+	std::map<std::pair<int, bool>, std::vector<size_t>> result;
+	for (size_t i = 0; i < mesh->num_triangles(); ++i) {
+		const int shader_index = (i < tri_shaders.size()) ? tri_shaders[i] : 0;
+		const bool smooth = (i < tri_smooth.size()) ? tri_smooth[i] : false;
+		result[std::make_pair(shader_index, smooth)].push_back(i);
+	}
+	return result;
+}
+
+// Returns true if the standalone renderer will rebuild vertex normals matching the ones on the mesh
+// Smooth groups are rebuilt by averaging face normals within the written element, flat groups ignore vertex normals entirely
+static bool mesh_normals_reproducible(const ccl::Mesh* const mesh)
+{
+	const ccl::Attribute* const normal_attr = mesh->attributes.find(ccl::ATTR_STD_VERTEX_NORMAL);
+	if (normal_attr == nullptr) {
+		return true;
+	}
+
+	// Loose enough to accept the difference between Max's and Cycles' weighting, tight enough to catch edited normals
+	const float MIN_NORMAL_COS = 0.985f;
+
+	const ccl::array<ccl::float3>& verts = mesh->get_verts();
+	const ccl::array<int>& triangles = mesh->get_triangles();
+	const ccl::float3* const mesh_normals = normal_attr->data_float3();
+
+	for (const auto& this_group : get_triangle_groups(mesh)) {
+		if (this_group.first.second == false) {
+			continue;
+		}
+
+		std::map<int, ccl::float3> rebuilt_normals;
+		for (const size_t tri_index : this_group.second) {
+			const ccl::float3 v0 = verts[triangles[tri_index * 3 + 0]];
+			const ccl::float3 v1 = verts[triangles[tri_index * 3 + 1]];
+			const ccl::float3 v2 = verts[triangles[tri_index * 3 + 2]];
+			const ccl::float3 face_normal = ccl::safe_normalize(ccl::cross(v1 - v0, v2 - v0));
+			for (int corner = 0; corner < 3; ++corner) {
+				const int vert_index = triangles[tri_index * 3 + corner];
+				auto rebuilt = rebuilt_normals.find(vert_index);
+				if (rebuilt == rebuilt_normals.end()) {
+					rebuilt_normals[vert_index] = face_normal;
+				}
+				else {
+					rebuilt->second += face_normal;
+				}
+			}
+		}
+
+		for (const auto& this_normal : rebuilt_normals) {
+			const ccl::float3 rebuilt = ccl::safe_normalize(this_normal.second);
+			const ccl::float3 original = ccl::safe_normalize(mesh_normals[this_normal.first]);
+			if (ccl::is_zero(rebuilt) || ccl::is_zero(original)) {
+				continue;
+			}
+			if (ccl::dot(rebuilt, original) < MIN_NORMAL_COS) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// Writes one state and mesh element for each shader and smoothing mode used by the mesh
+static void write_mesh_elements(
+	const ccl::Mesh* const mesh,
+	const std::map<const ccl::Node*, std::string>& shader_names,
+	ccl::xml_node parent
+	)
+{
+	const ccl::array<ccl::float3>& verts = mesh->get_verts();
+	const ccl::array<int>& triangles = mesh->get_triangles();
+	const ccl::array<ccl::Node*>& used_shaders = mesh->get_used_shaders();
+	const ccl::Attribute* const uv_attr = mesh->attributes.find(ccl::ATTR_STD_UV);
+
+	for (const auto& this_group : get_triangle_groups(mesh)) {
+		ccl::xml_node state_node = parent.append_child("state");
+		const int shader_index = this_group.first.first;
+		if (shader_index >= 0 && static_cast<size_t>(shader_index) < used_shaders.size()) {
+			const auto shader_name = shader_names.find(used_shaders[shader_index]);
+			if (shader_name != shader_names.end()) {
+				state_node.append_attribute("shader") = shader_name->second.c_str();
+			}
+		}
+		state_node.append_attribute("interpolation") = this_group.first.second ? "smooth" : "flat";
+
+		std::map<int, int> vert_remap;
+		std::vector<float> out_verts;
+		std::vector<int> out_indices;
+		std::vector<int> out_nverts;
+		std::vector<float> out_uvs;
+		for (const size_t tri_index : this_group.second) {
+			for (int corner = 0; corner < 3; ++corner) {
+				const int vert_index = triangles[tri_index * 3 + corner];
+				if (vert_remap.count(vert_index) == 0) {
+					const int new_index = static_cast<int>(vert_remap.size());
+					vert_remap[vert_index] = new_index;
+					out_verts.push_back(verts[vert_index].x);
+					out_verts.push_back(verts[vert_index].y);
+					out_verts.push_back(verts[vert_index].z);
+				}
+				out_indices.push_back(vert_remap[vert_index]);
+
+				if (uv_attr != nullptr) {
+					const ccl::float2 uv = uv_attr->data_float2()[tri_index * 3 + corner];
+					out_uvs.push_back(uv.x);
+					out_uvs.push_back(uv.y);
+				}
+			}
+			out_nverts.push_back(3);
+		}
+
+		ccl::xml_node mesh_node = state_node.append_child("mesh");
+		mesh_node.append_attribute("P") = get_float_stream_string(out_verts).c_str();
+		mesh_node.append_attribute("nverts") = get_int_stream_string(out_nverts).c_str();
+		mesh_node.append_attribute("verts") = get_int_stream_string(out_indices).c_str();
+		if (out_uvs.empty() == false) {
+			mesh_node.append_attribute("UV") = get_float_stream_string(out_uvs).c_str();
+		}
+	}
+}
+
+// Returns a description of everything in the scene that the standalone format can't represent
+static std::set<std::string> find_unsupported_features(const ccl::Scene* const scene)
+{
+	std::set<std::string> result;
+
+	if (scene->camera->get_motion().size() > 1) {
+		result.insert("camera motion blur");
+	}
+
+	for (const ccl::Object* const this_object : scene->objects) {
+		const ccl::Geometry* const geometry = this_object->get_geometry();
+		if (geometry == nullptr) {
+			continue;
+		}
+		if (geometry->geometry_type != ccl::Geometry::MESH) {
+			result.insert("hair, particle or volume geometry");
+			continue;
+		}
+		if (this_object->get_motion().size() > 0) {
+			result.insert("object motion blur");
+		}
+
+		const ccl::Mesh* const mesh = static_cast<const ccl::Mesh*>(geometry);
+		if (mesh->get_use_motion_blur()) {
+			result.insert("deformation motion blur");
+		}
+		if (mesh_normals_reproducible(mesh) == false) {
+			result.insert("explicit or edited normals");
+		}
+
+		size_t uv_count = 0;
+		for (const ccl::Attribute& this_attr : mesh->attributes.attributes) {
+			if (this_attr.std == ccl::ATTR_STD_UV) {
+				++uv_count;
+			}
+		}
+		if (uv_count > 1) {
+			result.insert("more than one UV channel");
+		}
+	}
+
+	return result;
+}
+
+bool write_scene_snapshot(ccl::Scene* const scene, const BakedTexmapCache& texmap_cache, const std::wstring& path, LoggerInterface& logger, std::string& error_out)
+{
+	logger << "write_scene_snapshot called..." << LogCtl::WRITE_LINE;
+
+	if (scene == nullptr) {
+		logger << "scene is null, skipping snapshot" << LogCtl::WRITE_LINE;
+		error_out = "scene was not translated";
+		return false;
+	}
+
+	// A snapshot that silently differs from the render is worse than none, so refuse to write one
+	const std::set<std::string> unsupported_features = find_unsupported_features(scene);
+	if (unsupported_features.empty() == false) {
+		error_out = "scene uses features the snapshot format does not support:";
+		for (const std::string& this_feature : unsupported_features) {
+			error_out += " " + this_feature + ",";
+		}
+		error_out.pop_back();
+		logger << LogLevel::ERR << error_out.c_str() << LogCtl::WRITE_LINE;
+		return false;
+	}
+
+	const size_t last_slash = path.find_last_of(L"\\/");
+	const std::wstring dir = (last_slash == std::wstring::npos) ? std::wstring() : path.substr(0, last_slash + 1);
+	std::wstring name_prefix = (last_slash == std::wstring::npos) ? path : path.substr(last_slash + 1);
+	const size_t last_dot = name_prefix.find_last_of(L'.');
+	if (last_dot != std::wstring::npos) {
+		name_prefix = name_prefix.substr(0, last_dot);
+	}
+	SnapshotImageWriter image_writer{ texmap_cache, utf8_from_wstring(dir), utf8_from_wstring(name_prefix) };
+
+	ccl::xml_document doc;
+	ccl::xml_node root = doc.append_child("cycles");
+	root.append_attribute("snapshot_version") = SNAPSHOT_FORMAT_VERSION;
+
+	// Settings
+	ccl::xml_write_node(scene->film, root);
+	ccl::xml_write_node(scene->integrator, root);
+	{
+		ccl::xml_node transform_node = root.append_child("transform");
+		transform_node.append_attribute("matrix") = get_matrix_string(scene->camera->get_matrix()).c_str();
+		ccl::xml_node camera_node = ccl::xml_write_node(scene->camera, transform_node);
+		camera_node.remove_attribute("matrix");
+		camera_node.append_attribute("width") = scene->camera->get_full_width();
+		camera_node.append_attribute("height") = scene->camera->get_full_height();
+	}
+
+	// Shaders, the default shaders already exist in any scene so they are referred to by their own names
+	std::map<const ccl::Node*, std::string> shader_names;
+	for (ccl::Shader* const this_shader : scene->shaders) {
+		const bool is_default = (
+			this_shader == scene->default_surface ||
+			this_shader == scene->default_volume ||
+			this_shader == scene->default_light ||
+			this_shader == scene->default_background ||
+			this_shader == scene->default_empty
+		);
+		if (is_default) {
+			shader_names[this_shader] = this_shader->name.string();
+			continue;
+		}
+
+		const std::string shader_name = "snapshot_shader_" + std::to_string(shader_names.size());
+		shader_names[this_shader] = shader_name;
+
+		ccl::xml_node shader_node = ccl::xml_write_node(this_shader, root);
+		set_xml_attribute(shader_node, "name", shader_name);
+		if (this_shader->graph != nullptr) {
+			write_shader_graph(this_shader->graph, shader_node, image_writer);
+		}
+	}
+
+	// The plugin builds the environment directly into the default background shader
+	{
+		ccl::xml_node background_node = ccl::xml_write_node(scene->background, root);
+		background_node.remove_attribute("shader");
+		if (scene->default_background->graph != nullptr) {
+			write_shader_graph(scene->default_background->graph, background_node, image_writer);
+		}
+	}
+
+	for (ccl::Light* const this_light : scene->lights) {
+		ccl::xml_node state_node = root.append_child("state");
+		const auto shader_name = shader_names.find(this_light->get_shader());
+		if (shader_name != shader_names.end()) {
+			state_node.append_attribute("shader") = shader_name->second.c_str();
+		}
+		ccl::xml_node light_node = ccl::xml_write_node(this_light, state_node);
+		light_node.remove_attribute("shader");
+	}
+
+	// Instanced meshes are written once to their own file, each instance includes that file under its own transform
+	std::map<const ccl::Geometry*, size_t> geometry_users;
+	for (const ccl::Object* const this_object : scene->objects) {
+		if (this_object->get_geometry() != nullptr) {
+			++geometry_users[this_object->get_geometry()];
+		}
+	}
+
+	std::map<const ccl::Geometry*, std::string> shared_mesh_paths;
+	for (const ccl::Object* const this_object : scene->objects) {
+		const ccl::Geometry* const geometry = this_object->get_geometry();
+		if (geometry == nullptr) {
+			continue;
+		}
+		const ccl::Mesh* const mesh = static_cast<const ccl::Mesh*>(geometry);
+
+		ccl::xml_node transform_node = root.append_child("transform");
+		transform_node.append_attribute("matrix") = get_matrix_string(this_object->get_tfm()).c_str();
+
+		if (geometry_users[geometry] < 2) {
+			write_mesh_elements(mesh, shader_names, transform_node);
+			continue;
+		}
+
+		if (shared_mesh_paths.count(geometry) == 0) {
+			const std::wstring mesh_suffix = L"_mesh" + std::to_wstring(shared_mesh_paths.size()) + L".xml";
+
+			ccl::xml_document mesh_doc;
+			ccl::xml_node mesh_root = mesh_doc.append_child("cycles");
+			write_mesh_elements(mesh, shader_names, mesh_root);
+			if (mesh_doc.save_file((dir + name_prefix + mesh_suffix).c_str()) == false) {
+				error_out = "unable to write instanced mesh file";
+				logger << LogLevel::ERR << error_out.c_str() << LogCtl::WRITE_LINE;
+				return false;
+			}
+
+			shared_mesh_paths[geometry] = utf8_from_wstring(name_prefix + mesh_suffix);
+		}
+
+		ccl::xml_node include_node = transform_node.append_child("include");
+		include_node.append_attribute("src") = shared_mesh_paths[geometry].c_str();
+	}
+
+	logger << "snapshot objects: " << scene->objects.size() << ", shared meshes: " << shared_mesh_paths.size() << LogCtl::WRITE_LINE;
+	logger << "snapshot images: " << image_writer.get_written_count() << LogCtl::WRITE_LINE;
+
+	const bool result = doc.save_file(path.c_str());
+	if (result == false) {
+		error_out = "unable to write file";
+	}
+	logger << "write_scene_snapshot complete, success: " << result << LogCtl::WRITE_LINE;
+	return result;
+}
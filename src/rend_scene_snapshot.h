@@ -0,0 +1,46 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#pragma once
+
+/**
+ * @file
+ * @brief Defines a function to write a translated Cycles scene to disk.
+ */
+
+#include <string>
+
+#include "rend_logger.h"
+
+namespace ccl {
+	class Scene;
+}
+
+class BakedTexmapCache;
+
+/**
+ * @brief Writes a translated scene as a Cycles standalone XML file, which can be rendered with the cycles command line tool.
+ *
+ * Baked texmaps are written as image files next to the XML file. Meshes used by several objects are written once to
+ * their own XML file and included by each instance. This must be called after texmaps have been baked and before the
+ * scene has been synced to the device.
+ *
+ * Nothing is written if the scene uses something the standalone format can't represent, such as hair, motion blur,
+ * normals that were edited away from what the smoothing groups produce or a second UV channel. On failure error_out
+ * describes the problem.
+ */
+bool write_scene_snapshot(ccl::Scene* scene, const BakedTexmapCache& texmap_cache, const std::wstring& path, LoggerInterface& logger, std::string& error_out);
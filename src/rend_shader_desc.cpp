@@ -21,6 +21,7 @@
 
 #include <iparamb2.h>
 
+#include "cache_shader_graph.h"
 #include "plugin_mat_add.h"
 #include "plugin_mat_anisotropic.h"
 #include "plugin_mat_diffuse.h"
@@ -629,6 +630,7 @@ ShaderGraphShaderDescriptor::ShaderGraphShaderDescriptor(CyclesShaderGraphMat08*
 	name(bad_from_wstring(mtl->GetName().data()))
 {
 	encoded_graph = mtl->GetNodeGraph();
+	graph_hash = hash_encoded_graph(encoded_graph);
 	mtl->PopulateShaderParamsDesc(&shader_params);
 
 	texmaps.resize(mtl->NumSubTexmaps(), nullptr);
@@ -642,6 +644,7 @@ ShaderGraphShaderDescriptor::ShaderGraphShaderDescriptor(CyclesShaderGraphMat16*
 	name(bad_from_wstring(mtl->GetName().data()))
 {
 	encoded_graph = mtl->GetNodeGraph();
+	graph_hash = hash_encoded_graph(encoded_graph);
 	mtl->PopulateShaderParamsDesc(&shader_params);
 
 	texmaps.resize(mtl->NumSubTexmaps(), nullptr);
@@ -655,6 +658,7 @@ ShaderGraphShaderDescriptor::ShaderGraphShaderDescriptor(CyclesShaderGraphMat32*
 	name(bad_from_wstring(mtl->GetName().data()))
 {
 	encoded_graph = mtl->GetNodeGraph();
+	graph_hash = hash_encoded_graph(encoded_graph);
 	mtl->PopulateShaderParamsDesc(&shader_params);
 
 	texmaps.resize(mtl->NumSubTexmaps(), nullptr);
@@ -668,6 +672,8 @@ bool ShaderGraphShaderDescriptor::operator<(const ShaderGraphShaderDescriptor& o
 {
 	LT_COMPARE(name);
 
+	// Compare hashes first so that different graphs can usually be ordered without a full string comparison
+	LT_COMPARE(graph_hash);
 	LT_COMPARE(encoded_graph);
 	LT_COMPARE(shader_params);
 
@@ -1642,16 +1648,18 @@ bool VolScatterShaderDescriptor::operator<(const VolScatterShaderDescriptor& oth
 	return false;
 }
 
-LightShaderDescriptor::LightShaderDescriptor(const ccl::float3 color_in, const float intensity_in)
+LightShaderDescriptor::LightShaderDescriptor(const ccl::float3 color_in, const float intensity_in, const int ies_profile_in)
 {
 	color = color_in;
 	intensity = intensity_in;
+	ies_profile = ies_profile_in;
 }
 
 bool LightShaderDescriptor::operator<(const LightShaderDescriptor& other) const
 {
 	LT_COMPARE(color);
 	LT_COMPARE(intensity);
+	LT_COMPARE(ies_profile);
 
 	return false;
 }
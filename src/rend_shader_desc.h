@@ -148,6 +148,7 @@ public:
 
 	ShaderParamsDescriptor shader_params;
 	std::string encoded_graph;
+	size_t graph_hash = 0;
 
 	std::vector<Texmap*> texmaps;
 
@@ -498,8 +499,10 @@ class LightShaderDescriptor {
 public:
 	ccl::float3 color;
 	float intensity;
+	// Index of the IES profile in the shader manager, -1 for uniform emission
+	int ies_profile;
 
-	LightShaderDescriptor(ccl::float3 color_in, float intensity_in);
+	LightShaderDescriptor(ccl::float3 color_in, float intensity_in, int ies_profile_in = -1);
 
 	bool operator<(const LightShaderDescriptor& other) const;
 };
@@ -18,6 +18,8 @@
 #include "rend_shader_graph_converter.h"
 
 #include <cassert>
+#include <mutex>
+#include <unordered_map>
 
 #include <boost/optional.hpp>
 
@@ -33,6 +35,7 @@
 #include <shader_graph/node.h>
 
 #include "cache_baked_texmap.h"
+#include "cache_shader_graph.h"
 
 static ccl::float3 float3_to_ccl_float3(const csc::Float3 in_vec)
 {
@@ -61,49 +64,74 @@ void ShaderGraphConverter::set_texmap_slot(Texmap* const texmap, const size_t sl
 	texmap_slots[slot] = texmap;
 }
 
+typedef std::unordered_map<std::string, const ccl::SocketType*> SocketIndex;
+
+// Returns a name->socket lookup table for the inputs of the given node type, built the first time each type is seen
+static const SocketIndex& get_input_socket_index(const ccl::NodeType* const node_type)
+{
+	static std::mutex index_mutex;
+	static std::unordered_map<const ccl::NodeType*, SocketIndex> socket_indices;
+
+	std::lock_guard<std::mutex> lock(index_mutex);
+
+	const auto existing_iter = socket_indices.find(node_type);
+	if (existing_iter != socket_indices.end()) {
+		return existing_iter->second;
+	}
+
+	SocketIndex& new_index = socket_indices[node_type];
+	for (const ccl::SocketType& socket_type : node_type->inputs) {
+		new_index.emplace(socket_type.name.string(), &socket_type);
+	}
+	return new_index;
+}
+
 static void apply_shader_param(ccl::Node& ccl_node, const csg::Node& csg_node, const char* name)
 {
-	for (const ccl::SocketType& socket_type : ccl_node.type->inputs) {
-		if (socket_type.name.string() == name) {
-			// We have found the matching input on the ccl::Node
-			const boost::optional<size_t> opt_index{ csg_node.slot_index(csg::SlotDirection::INPUT, name) };
-			if (opt_index) {
-				const boost::optional<csg::Slot> opt_slot{ csg_node.slot(*opt_index) };
-				if (opt_slot && opt_slot->value) {
-					if (const auto bool_val{ opt_slot->value->as<csg::BoolSlotValue>() }) {
-						ccl_node.set(socket_type, bool_val->get());
-					}
-					else if (const auto float3_val{ opt_slot->value->as<csg::ColorSlotValue>() }) {
-						ccl_node.set(socket_type, float3_to_ccl_float3(float3_val->get()));
-					}
-					else if (const auto float_val{ opt_slot->value->as<csg::FloatSlotValue>() }) {
-						ccl_node.set(socket_type, float_val->get());
-					}
-					else if (const auto float3_val{ opt_slot->value->as<csg::VectorSlotValue>() }) {
-						ccl_node.set(socket_type, float3_to_ccl_float3(float3_val->get()));
-					}
-				}
+	const SocketIndex& socket_index = get_input_socket_index(ccl_node.type);
+	const auto socket_iter = socket_index.find(name);
+	if (socket_iter == socket_index.end()) {
+		return;
+	}
+
+	// We have found the matching input on the ccl::Node
+	const ccl::SocketType& socket_type = *(socket_iter->second);
+	const boost::optional<size_t> opt_index{ csg_node.slot_index(csg::SlotDirection::INPUT, name) };
+	if (opt_index) {
+		const boost::optional<csg::Slot> opt_slot{ csg_node.slot(*opt_index) };
+		if (opt_slot && opt_slot->value) {
+			if (const auto bool_val{ opt_slot->value->as<csg::BoolSlotValue>() }) {
+				ccl_node.set(socket_type, bool_val->get());
+			}
+			else if (const auto float3_val{ opt_slot->value->as<csg::ColorSlotValue>() }) {
+				ccl_node.set(socket_type, float3_to_ccl_float3(float3_val->get()));
+			}
+			else if (const auto float_val{ opt_slot->value->as<csg::FloatSlotValue>() }) {
+				ccl_node.set(socket_type, float_val->get());
+			}
+			else if (const auto float3_val{ opt_slot->value->as<csg::VectorSlotValue>() }) {
+				ccl_node.set(socket_type, float3_to_ccl_float3(float3_val->get()));
 			}
 		}
 	}
 }
 
-ccl::ShaderGraph* ShaderGraphConverter::get_shader_graph(const std::string encoded_graph, ccl::Scene* const scene) const
+ccl::ShaderGraph* ShaderGraphConverter::get_shader_graph(const std::string& encoded_graph, const size_t graph_hash, ccl::Scene* const scene) const
 {
 	*logger << "get_shader_graph called..." << LogCtl::WRITE_LINE;
 	*logger << "encoded graph: " << encoded_graph.c_str() << LogCtl::WRITE_LINE;
 
 	ccl::ShaderGraph* const cycles_graph = new ccl::ShaderGraph();
 
-	const boost::optional<csg::Graph> opt_graph{ csg::Graph::from(encoded_graph) };
-	if (opt_graph.has_value() == false) {
+	const std::shared_ptr<const csg::Graph> parsed_graph{ global_shader_graph_cache.get_graph(encoded_graph, graph_hash) };
+	if (parsed_graph.use_count() == 0) {
 		// Serialized graph is not valid, return empty graph
 		return cycles_graph;
 	}
 
 	std::map<csg::NodeId, ccl::ShaderNode*> nodes_by_id;
 
-	const std::list<std::shared_ptr<csg::Node>> node_list{ opt_graph->nodes() };
+	const std::list<std::shared_ptr<csg::Node>> node_list{ parsed_graph->nodes() };
 	for (const std::shared_ptr<csg::Node> this_node : node_list) {
 		if (this_node.use_count() == 0) {
 			continue;
@@ -1602,7 +1630,7 @@ ccl::ShaderGraph* ShaderGraphConverter::get_shader_graph(const std::string encod
 
 
 
-	for (const csg::Connection this_connection : opt_graph->connections()) {
+	for (const csg::Connection this_connection : parsed_graph->connections()) {
 
 		*logger << "Adding connection..." << LogCtl::WRITE_LINE;
 
@@ -1614,9 +1642,9 @@ ccl::ShaderGraph* ShaderGraphConverter::get_shader_graph(const std::string encod
 		ccl::ShaderNode* const ccl_node_src{ nodes_by_id[this_connection.source().node_id()] };
 		ccl::ShaderNode* const ccl_node_dest{ nodes_by_id[this_connection.dest().node_id()] };
 
-		std::shared_ptr<const csg::Node> node_src{ opt_graph->get(this_connection.source().node_id()) };
+		std::shared_ptr<const csg::Node> node_src{ parsed_graph->get(this_connection.source().node_id()) };
 		assert(node_src.use_count() != 0);
-		std::shared_ptr<const csg::Node> node_dest{ opt_graph->get(this_connection.dest().node_id()) };
+		std::shared_ptr<const csg::Node> node_dest{ parsed_graph->get(this_connection.dest().node_id()) };
 		assert(node_dest.use_count() != 0);
 
 		const boost::optional<csg::Slot> opt_slot_src{ node_src->slot(this_connection.source().index()) };
@@ -24,6 +24,7 @@
 
 #include <map>
 #include <memory>
+#include <string>
 
 #include <util/util_types.h>
 
@@ -45,7 +46,7 @@ class ShaderGraphConverter {
 public:
 	ShaderGraphConverter(BakedTexmapCache& texmap_cache);
 	void set_texmap_slot(Texmap* texmap, size_t slot);
-	ccl::ShaderGraph* get_shader_graph(std::string encoded_graph, ccl::Scene* scene) const;
+	ccl::ShaderGraph* get_shader_graph(const std::string& encoded_graph, size_t graph_hash, ccl::Scene* scene) const;
 
 private:
 	std::map<size_t, Texmap*> texmap_slots;
@@ -17,9 +17,17 @@
  
 #include "rend_shader_manager.h"
 
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <render/attribute.h>
 #include <render/light.h>
+#include <render/mesh.h>
 #include <render/nodes.h>
+#include <render/object.h>
 #include <render/scene.h>
+#include <util/util_transform.h>
 
 #include "cache_baked_texmap.h"
 #include "const_classid.h"
@@ -53,6 +61,118 @@
 #include "util_color_temp.h"
 #include "util_pblock_dump.h"
 
+// Asks every node in the graph which attributes it needs so new tangent consumers can't be missed
+static bool shader_uses_uv_tangents(ccl::Shader* const shader)
+{
+	if (shader == nullptr || shader->graph == nullptr) {
+		return false;
+	}
+
+	// Nodes only request tangents for shaders with a surface, which is normally not known until the shader is compiled
+	const ccl::ShaderInput* const surface_input = shader->graph->output()->input("Surface");
+	const bool had_surface = shader->has_surface;
+	shader->has_surface = (surface_input != nullptr && surface_input->link != nullptr);
+
+	ccl::AttributeRequestSet requests;
+	for (ccl::ShaderNode* const node : shader->graph->nodes) {
+		node->attributes(shader, &requests);
+	}
+
+	shader->has_surface = had_surface;
+
+	return requests.find(ccl::ATTR_STD_UV_TANGENT);
+}
+
+static float average_color(const ccl::float3 color)
+{
+	return (color.x + color.y + color.z) / 3.0f;
+}
+
+// Returns a rough estimate of the radiance emitted by a shader, or 0 if it has no surface emission
+// Linked inputs cannot be evaluated here and are assumed to be 1
+static float estimate_shader_emission(const ccl::Shader* const shader)
+{
+	if (shader == nullptr || shader->graph == nullptr) {
+		return 0.0f;
+	}
+
+	float result = 0.0f;
+	for (ccl::ShaderNode* const node : shader->graph->nodes) {
+		if (const ccl::EmissionNode* const emission_node = dynamic_cast<const ccl::EmissionNode*>(node)) {
+			const float color = emission_node->input("Color")->link ? 1.0f : average_color(emission_node->get_color());
+			const float strength = emission_node->input("Strength")->link ? 1.0f : emission_node->get_strength();
+			result = std::max(result, color * strength);
+		}
+		else if (const ccl::PrincipledBsdfNode* const principled_node = dynamic_cast<const ccl::PrincipledBsdfNode*>(node)) {
+			const float color = principled_node->input("Emission")->link ? 1.0f : average_color(principled_node->get_emission());
+			const float strength = principled_node->input("Emission Strength")->link ? 1.0f : principled_node->get_emission_strength();
+			result = std::max(result, color * strength);
+		}
+	}
+
+	return result;
+}
+
+// Returns the largest value an IESLightNode will output for this profile at strength 1, or 0 if it can't be parsed
+// This reads the LM-63 layout and applies the same multipliers Cycles does when it loads the profile
+static float get_ies_peak_value(const std::string& content)
+{
+	const size_t tilt_pos = content.find("TILT=");
+	if (tilt_pos == std::string::npos) {
+		return 0.0f;
+	}
+	const size_t tilt_line_end = content.find('\n', tilt_pos);
+	if (tilt_line_end == std::string::npos) {
+		return 0.0f;
+	}
+
+	std::string data = content.substr(tilt_line_end + 1);
+	std::replace(data.begin(), data.end(), ',', ' ');
+	std::istringstream data_stream(data);
+
+	// Tilt data only changes the output with lamp orientation, it can't raise the peak so it is skipped
+	if (content.compare(tilt_pos, 12, "TILT=INCLUDE") == 0) {
+		double geometry = 0.0;
+		int tilt_pairs = 0;
+		data_stream >> geometry >> tilt_pairs;
+		for (int i = 0; i < 2 * tilt_pairs; i++) {
+			double ignored = 0.0;
+			data_stream >> ignored;
+		}
+	}
+
+	double lamps = 0.0, lumens = 0.0, multiplier = 0.0, vertical_count = 0.0, horizontal_count = 0.0;
+	double photometric_type = 0.0, units = 0.0, width = 0.0, length = 0.0, height = 0.0;
+	double ballast_factor = 0.0, ballast_lamp_factor = 0.0, watts = 0.0;
+	data_stream >> lamps >> lumens >> multiplier >> vertical_count >> horizontal_count;
+	data_stream >> photometric_type >> units >> width >> length >> height;
+	data_stream >> ballast_factor >> ballast_lamp_factor >> watts;
+	if (data_stream.fail() || vertical_count < 1.0 || horizontal_count < 1.0) {
+		return 0.0f;
+	}
+
+	const size_t angle_count = static_cast<size_t>(vertical_count) + static_cast<size_t>(horizontal_count);
+	for (size_t i = 0; i < angle_count; i++) {
+		double ignored = 0.0;
+		data_stream >> ignored;
+	}
+
+	double peak_candela = 0.0;
+	const size_t value_count = static_cast<size_t>(vertical_count) * static_cast<size_t>(horizontal_count);
+	for (size_t i = 0; i < value_count; i++) {
+		double candela = 0.0;
+		data_stream >> candela;
+		peak_candela = std::max(peak_candela, candela);
+	}
+	if (data_stream.fail()) {
+		return 0.0f;
+	}
+
+	// Cycles converts candela to watts per steradian with the luminous efficacy of D65
+	constexpr double CYCLES_IES_EFFICACY = 177.83;
+	return static_cast<float>(peak_candela * multiplier * ballast_factor * ballast_lamp_factor / CYCLES_IES_EFFICACY);
+}
+
 static ccl::ShaderOutput* get_closure_output(ccl::ShaderNode* const node)
 {
 	if (node == nullptr) {
@@ -133,6 +253,21 @@ ccl::Shader* MaxShaderManager::get_ccl_shader(const int index) const
 	return nullptr;
 }
 
+int MaxShaderManager::get_mis_map_size_for_image(const Int2 image_resolution) const
+{
+	// Smallest importance map built for a baked environment, so even tiny or constant images get a usable map
+	constexpr int MIN_MIS_MAP_SIZE = 64;
+
+	if (image_resolution.x() <= 0) {
+		return mis_map_size;
+	}
+
+	// The importance map cannot resolve more detail than the baked image it samples, anything larger is wasted work
+	const int result = std::min(mis_map_size, std::max(MIN_MIS_MAP_SIZE, image_resolution.x()));
+	*logger << "MIS map size: " << result << " for environment width: " << image_resolution.x() << LogCtl::WRITE_LINE;
+	return result;
+}
+
 void MaxShaderManager::set_mis_map_size(const int size)
 {
 	mis_map_size = size;
@@ -239,10 +374,13 @@ void MaxShaderManager::set_bitmap_sky_shader(
 
 	ccl::ShaderGraph* const graph = new ccl::ShaderGraph();
 
+	// Resolution of the image that lights the scene, this is the image the MIS importance map is built from
+	Int2 mis_image_resolution(0, 0);
+
 	ccl::ShaderNode* bg_tex_node = nullptr;
 	if (bg_map != nullptr) {
 		if (use_env_node_for_projection(bg_proj)) {
-			ccl::EnvironmentTextureNode* const bg_env_node = texmap_cache.get_env_node_from_texmap(bg_map, scene);
+			ccl::EnvironmentTextureNode* const bg_env_node = texmap_cache.get_env_node_from_texmap(bg_map, scene, &mis_image_resolution);
 			bg_env_node->set_projection(get_ccl_projection(bg_proj));
 			graph->add(bg_env_node);
 
@@ -268,7 +406,7 @@ void MaxShaderManager::set_bitmap_sky_shader(
 
 	ccl::ImageSlotTextureNode* light_tex_node = nullptr;
 	if (light_map != nullptr) {
-		ccl::EnvironmentTextureNode* light_env_node = texmap_cache.get_env_node_from_texmap(light_map, scene);
+		ccl::EnvironmentTextureNode* light_env_node = texmap_cache.get_env_node_from_texmap(light_map, scene, &mis_image_resolution);
 		light_env_node->set_projection(get_ccl_projection(light_proj));
 		graph->add(light_env_node);
 
@@ -314,7 +452,7 @@ void MaxShaderManager::set_bitmap_sky_shader(
 	ccl::Light* const light = new ccl::Light();
 	light->set_shader(bg_shader);
 	light->set_light_type(ccl::LightType::LIGHT_BACKGROUND);
-	light->set_map_resolution(mis_map_size);
+	light->set_map_resolution(get_mis_map_size_for_image(mis_image_resolution));
 	light->set_use_mis(true);
 	light->set_max_bounces(1024);
 
@@ -334,13 +472,19 @@ MaxMultiShaderHelper MaxShaderManager::get_mtl_multishader(Mtl* const mtl)
 			}
 		}
 
+		for (ccl::Shader* const shader : result.mesh_shader_vector) {
+			result.uses_uv_tangents = result.uses_uv_tangents || (uv_tangent_shaders.count(shader) > 0);
+		}
+
 		return result;
 	}
 	else {
 		*logger << "Non-multi-material found, getting material shader..." << LogCtl::WRITE_LINE;
 		const int scene_shader_index = get_mtl_shader(mtl);
 		*logger << "Found shader in slot: " << scene_shader_index << LogCtl::WRITE_LINE;
-		return MaxMultiShaderHelper(scene->shaders[scene_shader_index]);
+		MaxMultiShaderHelper result(scene->shaders[scene_shader_index]);
+		result.uses_uv_tangents = (uv_tangent_shaders.count(scene->shaders[scene_shader_index]) > 0);
+		return result;
 	}
 }
 
@@ -667,9 +811,9 @@ int MaxShaderManager::get_simple_color_shader(const ccl::float3 color)
 	return simple_color_shaders[comp_color];
 }
 
-int MaxShaderManager::get_light_shader(const ccl::float3 color, const float intensity)
+int MaxShaderManager::get_light_shader(const ccl::float3 color, const float intensity, const std::wstring& ies_file)
 {
-	const LightShaderDescriptor desc(color, intensity);
+	const LightShaderDescriptor desc(color, intensity, get_ies_profile(ies_file));
 
 	if (light_shaders.count(desc) == 0) {
 		light_shaders[desc] = add_light_shader(desc);
@@ -677,6 +821,86 @@ int MaxShaderManager::get_light_shader(const ccl::float3 color, const float inte
 	return light_shaders[desc];
 }
 
+void MaxShaderManager::update_emission_mis(const float threshold)
+{
+	*logger << "update_emission_mis called with threshold: " << threshold << LogCtl::WRITE_LINE;
+
+	if (emissive_shaders.empty()) {
+		return;
+	}
+
+	// Emission of the largest single emitter using each shader, MIS is a shader setting so all objects must agree
+	std::map<ccl::Shader*, float> largest_emission;
+
+	for (ccl::Object* const this_object : scene->objects) {
+		ccl::Geometry* const geometry = this_object->get_geometry();
+		if (geometry == nullptr || geometry->geometry_type != ccl::Geometry::MESH) {
+			continue;
+		}
+		const ccl::Mesh* const mesh = static_cast<const ccl::Mesh*>(geometry);
+
+		const ccl::array<ccl::Node*>& used_shaders = mesh->get_used_shaders();
+		std::vector<float> shader_radiance(used_shaders.size(), 0.0f);
+		bool any_emissive = false;
+		for (size_t i = 0; i < used_shaders.size(); ++i) {
+			const auto emissive_iter = emissive_shaders.find(static_cast<ccl::Shader*>(used_shaders[i]));
+			if (emissive_iter != emissive_shaders.end()) {
+				shader_radiance[i] = emissive_iter->second;
+				any_emissive = true;
+			}
+		}
+		if (any_emissive == false) {
+			continue;
+		}
+
+		const ccl::Transform& tfm = this_object->get_tfm();
+		const ccl::array<ccl::float3>& verts = mesh->get_verts();
+		const ccl::array<int>& triangles = mesh->get_triangles();
+		const ccl::array<int>& tri_shaders = mesh->get_shader();
+
+		std::vector<float> emissive_area(used_shaders.size(), 0.0f);
+		for (size_t tri = 0; tri < tri_shaders.size(); ++tri) {
+			const int shader_index = tri_shaders[tri];
+			if (shader_index < 0 || static_cast<size_t>(shader_index) >= used_shaders.size() || shader_radiance[shader_index] <= 0.0f) {
+				continue;
+			}
+			const ccl::float3 p0 = ccl::transform_point(&tfm, verts[triangles[tri * 3 + 0]]);
+			const ccl::float3 p1 = ccl::transform_point(&tfm, verts[triangles[tri * 3 + 1]]);
+			const ccl::float3 p2 = ccl::transform_point(&tfm, verts[triangles[tri * 3 + 2]]);
+			emissive_area[shader_index] += 0.5f * ccl::len(ccl::cross(p1 - p0, p2 - p0));
+		}
+
+		float object_area = 0.0f;
+		for (size_t i = 0; i < used_shaders.size(); ++i) {
+			object_area += emissive_area[i];
+			if (emissive_area[i] > 0.0f) {
+				ccl::Shader* const shader = static_cast<ccl::Shader*>(used_shaders[i]);
+				largest_emission[shader] = std::max(largest_emission[shader], emissive_area[i] * shader_radiance[i]);
+			}
+		}
+		*logger << "emissive object: " << this_object->name.c_str() << ", area: " << object_area << LogCtl::WRITE_LINE;
+	}
+
+	// A shader shared by one large emitter keeps MIS on for every object using it, including tiny ones
+	// Shaders are created fresh for every scene build, so MIS never has to be turned back on here
+	int disabled_count = 0;
+	for (const auto& this_pair : largest_emission) {
+		ccl::Shader* const shader = this_pair.first;
+		if (this_pair.second < threshold) {
+			if (shader->get_use_mis()) {
+				shader->set_use_mis(false);
+				shader->tag_update(scene);
+				++disabled_count;
+			}
+		}
+		else if (shader->get_use_mis() == false) {
+			*logger << LogLevel::WARN << "material has MIS off but emits above the threshold: " << shader->name.c_str() << ", emission: " << this_pair.second << LogCtl::WRITE_LINE;
+		}
+	}
+
+	*logger << "emissive shaders in use: " << largest_emission.size() << ", mis disabled: " << disabled_count << LogCtl::WRITE_LINE;
+}
+
 void MaxShaderManager::log_shader_stats() const
 {
 	*logger << LogCtl::SEPARATOR;
@@ -705,6 +929,9 @@ void MaxShaderManager::log_shader_stats() const
 	*logger << "Physical Material shaders: " << adsk_phys_shaders.size() << LogCtl::WRITE_LINE;
 	*logger << "           Simple shaders: " << simple_color_shaders.size() << LogCtl::WRITE_LINE;
 	*logger << "            Light shaders: " << light_shaders.size() << LogCtl::WRITE_LINE;
+	*logger << "             IES profiles: " << ies_profiles.size() << LogCtl::WRITE_LINE;
+	*logger << "       UV tangent shaders: " << uv_tangent_shaders.size() << LogCtl::WRITE_LINE;
+	*logger << "         Emissive shaders: " << emissive_shaders.size() << LogCtl::WRITE_LINE;
 	*logger << LogCtl::SEPARATOR;
 }
 
@@ -750,7 +977,7 @@ int MaxShaderManager::add_shader_graph_shader(const ShaderGraphShaderDescriptor&
 	}
 	*logger << "Got shader graph from converter" << LogCtl::WRITE_LINE;
 
-	ccl::ShaderGraph* const graph = converter.get_shader_graph(desc.encoded_graph, scene);
+	ccl::ShaderGraph* const graph = converter.get_shader_graph(desc.encoded_graph, desc.graph_hash, scene);
 	ccl::Shader* const shader = new ccl::Shader();
 
 	shader->set_use_mis(desc.shader_params.use_mis);
@@ -2474,9 +2701,60 @@ ccl::ShaderNode* MaxShaderManager::add_light_shader_nodes(ccl::ShaderGraph* cons
 	emission_node->set_strength(desc.intensity);
 	graph->add(emission_node);
 
+	if (desc.ies_profile >= 0 && static_cast<size_t>(desc.ies_profile) < ies_profiles.size()) {
+		// Scale the profile so its brightest direction emits the light's own intensity
+		// This leaves the Max intensity as the only brightness control, as it is for lights without a profile
+		const float peak_value = ies_profile_peaks[desc.ies_profile];
+		const float ies_strength = (peak_value > 0.0f) ? desc.intensity / peak_value : desc.intensity;
+
+		ccl::IESLightNode* const ies_node = new ccl::IESLightNode();
+		ies_node->set_ies(ccl::ustring(ies_profiles[desc.ies_profile]));
+		ies_node->set_strength(ies_strength);
+		graph->add(ies_node);
+
+		graph->connect(ies_node->output("Fac"), emission_node->input("Strength"));
+	}
+
 	return emission_node;
 }
 
+int MaxShaderManager::get_ies_profile(const std::wstring& ies_file)
+{
+	if (ies_file.empty()) {
+		return -1;
+	}
+
+	if (ies_file_profiles.count(ies_file) == 0) {
+		int profile_index = -1;
+
+		std::ifstream input_file(ies_file, std::ifstream::in);
+		if (input_file.good()) {
+			std::stringstream content_stream;
+			content_stream << input_file.rdbuf();
+			const std::string content = content_stream.str();
+
+			// Different paths holding the same profile share one entry and so one set of shaders
+			if (ies_profile_indices.count(content) == 0) {
+				const float peak_value = get_ies_peak_value(content);
+				if (peak_value <= 0.0f) {
+					*logger << LogLevel::WARN << "Unable to find IES peak intensity, profile will not be normalized: " << ies_file.c_str() << LogCtl::WRITE_LINE;
+				}
+				ies_profile_indices[content] = static_cast<int>(ies_profiles.size());
+				ies_profiles.push_back(content);
+				ies_profile_peaks.push_back(peak_value);
+			}
+			profile_index = ies_profile_indices[content];
+		}
+		else {
+			*logger << LogLevel::WARN << "Failed to read IES file: " << ies_file.c_str() << LogCtl::WRITE_LINE;
+		}
+
+		ies_file_profiles[ies_file] = profile_index;
+	}
+
+	return ies_file_profiles[ies_file];
+}
+
 ccl::ShaderNode* MaxShaderManager::add_nodes_for_mtl(ccl::ShaderGraph* const graph, Mtl* const mtl)
 {
 	Class_ID mtl_class = mtl->ClassID();
@@ -2637,5 +2915,12 @@ int MaxShaderManager::add_shader_to_scene(ccl::Shader* const new_shader)
 {
 	const int result = static_cast<int>(scene->shaders.size());
 	scene->shaders.push_back(new_shader);
+	if (shader_uses_uv_tangents(new_shader)) {
+		uv_tangent_shaders.insert(new_shader);
+	}
+	const float emission = estimate_shader_emission(new_shader);
+	if (emission > 0.0f) {
+		emissive_shaders[new_shader] = emission;
+	}
 	return result;
 }
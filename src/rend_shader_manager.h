@@ -24,12 +24,16 @@
 
 #include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <vector>
 
 #include <kernel/svm/svm_types.h>
 
 #include "rend_logger.h"
 #include "rend_shader_desc.h"
 #include "util_multi_shader_max.h"
+#include "util_simple_types.h"
 
 class BakedTexmapCache;
 
@@ -96,7 +100,10 @@ public:
 
 	int get_simple_color_shader(ccl::float3 color);
 
-	int get_light_shader(ccl::float3 color, float intensity);
+	int get_light_shader(ccl::float3 color, float intensity, const std::wstring& ies_file = std::wstring());
+
+	// Turns MIS off for emissive shaders where no single object using them emits more than threshold
+	void update_emission_mis(float threshold);
 
 	void log_shader_stats() const;
 
@@ -139,6 +146,19 @@ private:
 
 	std::map<LightShaderDescriptor, int> light_shaders;
 
+	// IES profiles are stored once per distinct file content, many fixtures usually share a handful of profiles
+	std::vector<std::string> ies_profiles;
+	// Largest value each profile outputs at strength 1, used to normalize profiles to the light's intensity
+	std::vector<float> ies_profile_peaks;
+	std::map<std::string, int> ies_profile_indices;
+	std::map<std::wstring, int> ies_file_profiles;
+
+	// Shaders containing a node that reads UV tangents, used to decide whether meshes need tangents at all
+	std::set<const ccl::Shader*> uv_tangent_shaders;
+
+	// Shaders with surface emission, mapped to a rough estimate of their emitted radiance
+	std::map<ccl::Shader*, float> emissive_shaders;
+
 	// Each type of shader has 2 functions for creation
 	// add_[type]_shader creates a shader and adds it to the scene
 	// add_[type]_shader_nodes adds the nodes needed for the shader to the given graph and returns the output node
@@ -196,11 +216,17 @@ private:
 
 	ccl::ShaderNode* add_light_shader_nodes(ccl::ShaderGraph* graph, const LightShaderDescriptor& desc);
 
+	// Returns the index of the profile loaded from the given file, or -1 if it could not be read
+	int get_ies_profile(const std::wstring& ies_file);
+
 	ccl::ShaderNode* add_nodes_for_mtl(ccl::ShaderGraph* graph, Mtl* mtl);
 
 	ccl::NormalMapNode* add_normal_map_to_graph(ccl::ShaderGraph* graph, const NormalMapDescriptor& desc);
 
 	int add_shader_to_scene(ccl::Shader* new_shader);
 
+	// Returns the background light importance map resolution to use for an environment baked at image_resolution
+	int get_mis_map_size_for_image(Int2 image_resolution) const;
+
 	const std::unique_ptr<LoggerInterface> logger;
 };
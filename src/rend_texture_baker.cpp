@@ -17,6 +17,9 @@
  
 #include "rend_texture_baker.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include <util/util_types.h>
 
 #include <Materials/Texmap.h>
@@ -175,6 +178,87 @@ static void radial_sample_float(Texmap* texmap, int width, int height, int first
 	}
 }
 
+////////
+// Returns true if two samples are equal within tolerance
+// The tolerance is relative for bright HDR values and absolute for everything else
+static bool colors_match(const AColor& a, const AColor& b)
+{
+	constexpr float CONSTANT_TEXMAP_TOLERANCE = 1.0f / 512.0f;
+	const float channels_a[] = { a.r, a.g, a.b, a.a };
+	const float channels_b[] = { b.r, b.g, b.b, b.a };
+	for (int i = 0; i < 4; i++) {
+		const float magnitude = std::max(1.0f, std::max(std::abs(channels_a[i]), std::abs(channels_b[i])));
+		if (std::abs(channels_a[i] - channels_b[i]) > CONSTANT_TEXMAP_TOLERANCE * magnitude) {
+			return false;
+		}
+	}
+	return true;
+}
+
+////////
+// Returns true if a bitmap appears anywhere in this texmap's tree
+// Image content can hold detail much finer than any probe grid so these maps are never treated as constant
+static bool texmap_uses_bitmap(Texmap* const texmap)
+{
+	if (texmap->ClassID() == BITMAP_MAP_CLASS) {
+		return true;
+	}
+	for (int i = 0; i < texmap->NumSubTexmaps(); i++) {
+		Texmap* const sub_texmap = texmap->GetSubTexmap(i);
+		if (sub_texmap != nullptr && texmap_uses_bitmap(sub_texmap)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool is_texmap_constant(Texmap* const texmap, const int width, const int height, const bool use_radial_sampling, const TimeValue t)
+{
+	assert(texmap != nullptr);
+
+	if (texmap_uses_bitmap(texmap)) {
+		return false;
+	}
+
+	CyclesTexmapScontext sc(t, false, width, height);
+
+	bool have_first_sample = false;
+	AColor first_sample;
+
+	// Probes are hierarchical, the two coarse grids reject most varying maps within a few samples
+	// Coprime sizes are used so a regular pattern is unlikely to line up with every probe
+	// Only maps that pass both coarse grids pay for the dense grid, which still costs far less than a full bake
+	const int grid_sizes[] = { 8, 7, 61 };
+	for (const int grid_size : grid_sizes) {
+		for (int grid_y = 0; grid_y < grid_size; grid_y++) {
+			for (int grid_x = 0; grid_x < grid_size; grid_x++) {
+				// Probe the center of the image pixel that lies at the center of this grid cell
+				const int x = std::min(width - 1, ((2 * grid_x + 1) * width) / (2 * grid_size));
+				const int y = std::min(height - 1, ((2 * grid_y + 1) * height) / (2 * grid_size));
+				if (use_radial_sampling) {
+					sc.SetUVFromRadialPixel(x, y, width, height);
+				}
+				else {
+					Point2 uv;
+					find_grid_box_center(x, y, width, height, uv.x, uv.y);
+					sc.SetUV(uv, x, (width - 1 - y));
+				}
+
+				const AColor sample = texmap->EvalColor(sc);
+				if (have_first_sample == false) {
+					first_sample = sample;
+					have_first_sample = true;
+				}
+				else if (colors_match(first_sample, sample) == false) {
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
 void run_baking_job(TexmapBakingJob job)
 {
 	Texmap* const texmap = job.texmap;
@@ -39,6 +39,14 @@
 class MaxTextureBaker;
 class Texmap;
 
+/**
+ * @brief Samples probe grids of a texmap and returns true if every sample has the same color within tolerance.
+ *
+ * Used to detect maps that resolve to a flat color so they can be baked as a single pixel. width and height are the
+ * resolution the texmap would otherwise be baked at. Always returns false for texmaps that contain a bitmap.
+ */
+bool is_texmap_constant(Texmap* texmap, int width, int height, bool use_radial_sampling, TimeValue t);
+
 /**
  * @brief Class to hold all information needed for a single baking job.
  */
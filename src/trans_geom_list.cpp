@@ -17,6 +17,8 @@
  
 #include "trans_geom_list.h"
 
+#include <set>
+
 #include <RenderingAPI/Renderer/IRenderSessionContext.h>
 #include <RenderingAPI/Renderer/ISceneContainer.h>
 
@@ -26,6 +28,24 @@ using MaxSDK::RenderingAPI::ISceneContainer;
 using MaxSDK::RenderingAPI::ITranslationProgress;
 using MaxSDK::RenderingAPI::TranslationResult;
 
+static size_t estimate_geometry_memory(const MeshGeometryObj& mesh_geom)
+{
+	size_t result = 0;
+	result += mesh_geom.verts.size() * sizeof(ccl::float3);
+	result += mesh_geom.normals.size() * sizeof(ccl::float3);
+	result += mesh_geom.faces.size() * sizeof(TriangleFace);
+	result += mesh_geom.uvw_verts.size() * sizeof(ccl::float3);
+	result += mesh_geom.uvw_tangents.size() * sizeof(ccl::float3);
+	result += mesh_geom.uvw_tangent_signs.size() * sizeof(float);
+	for (const std::vector<ccl::float3>& this_step : mesh_geom.motion_verts) {
+		result += this_step.size() * sizeof(ccl::float3);
+	}
+	for (const std::vector<ccl::float3>& this_step : mesh_geom.motion_normals) {
+		result += this_step.size() * sizeof(ccl::float3);
+	}
+	return result;
+}
+
 CyclesGeometryListTranslator::CyclesGeometryListTranslator(const TranslatorKey& /*key*/, MaxSDK::RenderingAPI::TranslatorGraphNode& translator_graph_node) :
 	MaxSDK::RenderingAPI::Translator(translator_graph_node),
 	logger(global_log_manager.new_logger(L"CyclesGeomListTranslator", false, true))
@@ -93,6 +113,27 @@ static_assert(false);
 
 	*logger << "All nodes complete" << LogCtl::WRITE_LINE;
 
+	// Objects sharing a mesh are one geometry object with several instances
+	stat_geom_objects = 0;
+	stat_geom_instances = 0;
+	stat_face_count = 0;
+	stat_geometry_memory = 0;
+	std::set<const MeshGeometryObj*> counted_meshes;
+	for (const CyclesGeomObject& this_geom_object : result.geom_objects) {
+		const MeshGeometryObj* const mesh_geom = this_geom_object.mesh_geometry.get();
+		if (mesh_geom == nullptr) {
+			continue;
+		}
+		++stat_geom_instances;
+		if (counted_meshes.insert(mesh_geom).second) {
+			++stat_geom_objects;
+			stat_face_count += mesh_geom->faces.size();
+			stat_geometry_memory += estimate_geometry_memory(*mesh_geom);
+		}
+	}
+
+	*logger << "Geometry objects: " << stat_geom_objects << ", instances: " << stat_geom_instances << LogCtl::WRITE_LINE;
+
 	SetOutput_SimpleValue<CyclesSceneGeometryList>(0, result);
 
 	new_validity = FOREVER;
@@ -118,9 +159,12 @@ void CyclesGeometryListTranslator::PostTranslate(const TimeValue /*translationTi
 	// Do nothing
 }
 
-void CyclesGeometryListTranslator::AccumulateStatistics(MaxSDK::RenderingAPI::TranslatorStatistics& /*stats*/) const
+void CyclesGeometryListTranslator::AccumulateStatistics(MaxSDK::RenderingAPI::TranslatorStatistics& stats) const
 {
-	// Do nothing
+	stats.AddGeomObjects(stat_geom_objects);
+	stats.AddGeomInstances(stat_geom_instances);
+	stats.AddFaces(stat_face_count);
+	stats.AddGeometryMemory(stat_geometry_memory);
 }
 
 Interval CyclesGeometryListTranslator::CheckValidity(const TimeValue /*t*/, const Interval& previous_validity) const
@@ -22,6 +22,7 @@
  * @brief Defines the translator class CyclesGeometryListTranslator.
  */
 
+#include <cstddef>
 #include <vector>
 
 #include <RenderingAPI/Renderer/ISceneContainer.h>
@@ -60,5 +61,11 @@ public:
 	virtual void NotifySceneBoundingBoxChanged() override;
 
 private:
+	// Statistics from the most recent translation, reported through AccumulateStatistics
+	size_t stat_geom_objects = 0;
+	size_t stat_geom_instances = 0;
+	size_t stat_face_count = 0;
+	size_t stat_geometry_memory = 0;
+
 	const std::unique_ptr<LoggerInterface> logger;
 };
@@ -17,6 +17,8 @@
  
 #include "trans_geom_node.h"
 
+#include <chrono>
+
 #include <inode.h>
 #include <modstack.h>
 #include <NotificationAPI/NotificationAPI_Events.h>
@@ -77,6 +79,8 @@ static_assert(false);
 {
 	*logger << "Translate called..." << LogCtl::WRITE_LINE;
 
+	const std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+
 	GetRenderSessionContext().CallRenderBegin(GetNode(), translation_time);
 
 	ObjectState os = GetNode().EvalWorldState(translation_time);
@@ -99,6 +103,11 @@ static_assert(false);
 
 	std::vector<int> empty_motion_sample_vector;
 	std::shared_ptr<MeshGeometryObj> mesh_geom = get_mesh_geometry(&(GetNode()), mesh_view, translation_time, empty_motion_sample_vector);
+	if (mesh_geom && previous_mesh_geom && *mesh_geom == *previous_mesh_geom) {
+		*logger << "Geometry unchanged, reusing previous mesh" << LogCtl::WRITE_LINE;
+		mesh_geom = previous_mesh_geom;
+	}
+	previous_mesh_geom = mesh_geom;
 
 	INode* const node_ptr = &(GetNode());
 	CyclesGeomObject result = get_geom_object(translation_time, node_ptr, std::vector<int>());
@@ -111,6 +120,14 @@ static_assert(false);
 
 	new_validity = geom_obj->ObjectValidity(translation_time);
 
+	const std::chrono::steady_clock::time_point end_time = std::chrono::steady_clock::now();
+	const std::chrono::duration<float, std::milli> translate_duration = end_time - begin_time;
+
+	// TranslatorStatistics has no field for vertex count or time, so these are only logged
+	if (mesh_geom) {
+		*logger << "Translated " << mesh_geom->faces.size() << " faces, " << mesh_geom->verts.size() << " verts" << LogCtl::WRITE_LINE;
+	}
+	*logger << "Translate time (ms): " << translate_duration.count() << LogCtl::WRITE_LINE;
 	*logger << "Translate complete" << LogCtl::WRITE_LINE;
 
 	return TranslationResult::Success;
@@ -127,7 +144,7 @@ MaxSDK::RenderingAPI::TranslationResult CyclesGeomNodeTranslator::TranslateKeyfr
 
 void CyclesGeomNodeTranslator::AccumulateStatistics(MaxSDK::RenderingAPI::TranslatorStatistics& /*stats*/) const
 {
-	// Do nothing
+	// Geometry is reported by CyclesGeometryListTranslator, which can see when several nodes share a mesh
 }
 
 Interval CyclesGeomNodeTranslator::CheckValidity(const TimeValue /*t*/, const Interval& /*previous_validity*/) const
@@ -65,6 +65,9 @@ private:
 	std::vector<unsigned int> uv_channels_present;
 	std::vector<MtlID> mtl_ids_present;
 
+	// Geometry from the previous translation, reused when the new geometry is identical so that the output compares equal
+	std::shared_ptr<MeshGeometryObj> previous_mesh_geom;
+
 	const std::unique_ptr<LoggerInterface> logger;
 };
 
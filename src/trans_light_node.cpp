@@ -20,6 +20,7 @@
 #include <inode.h>
 #include <object.h>
 #include <RenderingAPI/Renderer/IRenderSessionContext.h>
+#include <RenderingAPI/Renderer/IRenderingLogger.h>
 
 #include "util_translate_light.h"
 
@@ -68,6 +69,9 @@ static_assert(false);
 	}
 
 	const CyclesLightParams result = get_light_params(node_ptr, os.obj, translation_time);
+	if (result.warning_string.empty() == false) {
+		GetRenderSessionContext().GetLogger().LogMessage(MaxSDK::RenderingAPI::IRenderingLogger::MessageType::Warning, result.warning_string.c_str());
+	}
 
 	SetOutput_SimpleValue<CyclesLightParams>(0, result);
 	new_validity = os.obj->ObjectValidity(translation_time);
@@ -84,9 +88,12 @@ MaxSDK::RenderingAPI::TranslationResult CyclesLightNodeTranslator::TranslateKeyf
 	return MaxSDK::RenderingAPI::TranslationResult::Success;
 }
 
-void CyclesLightNodeTranslator::AccumulateStatistics(MaxSDK::RenderingAPI::TranslatorStatistics& /*stats*/) const
+void CyclesLightNodeTranslator::AccumulateStatistics(MaxSDK::RenderingAPI::TranslatorStatistics& stats) const
 {
-	// Do nothing
+	CyclesLightParams light_params;
+	if (GetLightParams(light_params) && light_params.active) {
+		stats.AddLights(1);
+	}
 }
 
 Interval CyclesLightNodeTranslator::CheckValidity(const TimeValue /*t*/, const Interval& /*previous_validity*/) const
@@ -112,7 +112,7 @@ void CyclesMaterialListTranslator::PostTranslate(const TimeValue /*translationTi
 
 void CyclesMaterialListTranslator::AccumulateStatistics(MaxSDK::RenderingAPI::TranslatorStatistics& /*stats*/) const
 {
-	// Do nothing
+	// TranslatorStatistics only counts geometry, lights and memory, it has nowhere to put a material count
 }
 
 Interval CyclesMaterialListTranslator::CheckValidity(const TimeValue /*t*/, const Interval& previous_validity) const
@@ -93,7 +93,7 @@ MaxSDK::RenderingAPI::TranslationResult CyclesMtlNodeTranslator::TranslateKeyfra
 
 void CyclesMtlNodeTranslator::AccumulateStatistics(MaxSDK::RenderingAPI::TranslatorStatistics& /*stats*/) const
 {
-	// Do nothing
+	// Materials have no counterpart in TranslatorStatistics
 }
 
 Interval CyclesMtlNodeTranslator::CheckValidity(const TimeValue /*t*/, const Interval& /*previous_validity*/) const
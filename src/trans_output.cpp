@@ -193,6 +193,49 @@ TriangleFace::TriangleFace(const int v0, const int v1, const int v2, const int s
 
 }
 
+bool TriangleFace::operator==(const TriangleFace& other) const
+{
+	return (
+		v0 == other.v0 &&
+		v1 == other.v1 &&
+		v2 == other.v2 &&
+		shader_mtl_index == other.shader_mtl_index &&
+		smooth == other.smooth
+		);
+}
+
+bool TriangleFace::operator!=(const TriangleFace& other) const
+{
+	return !(operator==(other));
+}
+
+bool MeshGeometryObj::operator==(const MeshGeometryObj& other) const
+{
+	// Cheap size checks first so that meshes with changed topology are rejected without comparing contents
+	if (verts.size() != other.verts.size() || faces.size() != other.faces.size() || uvw_verts.size() != other.uvw_verts.size()) {
+		return false;
+	}
+
+	return (
+		use_mesh_motion_blur == other.use_mesh_motion_blur &&
+		faces == other.faces &&
+		verts == other.verts &&
+		normals == other.normals &&
+		uvw_verts == other.uvw_verts &&
+		uvw_tangents == other.uvw_tangents &&
+		uvw_tangent_signs == other.uvw_tangent_signs &&
+		motion_verts == other.motion_verts &&
+		motion_normals == other.motion_normals &&
+		uv_channels_present == other.uv_channels_present &&
+		mtl_ids_present == other.mtl_ids_present
+		);
+}
+
+bool MeshGeometryObj::operator!=(const MeshGeometryObj& other) const
+{
+	return !(operator==(other));
+}
+
 CyclesGeomObject::CyclesGeomObject()
 {
 	wire_color = ccl::make_float3(0.0f, 0.0f, 0.0f);
@@ -206,6 +249,7 @@ bool CyclesGeomObject::operator==(const CyclesGeomObject& other) const
 		tfm_pre == other.tfm_pre &&
 		tfm == other.tfm &&
 		tfm_post == other.tfm_post &&
+		motion_tfms == other.motion_tfms &&
 		random_id == other.random_id &&
 		mesh_geometry == other.mesh_geometry &&
 		mtl == other.mtl &&
@@ -255,11 +299,22 @@ bool CyclesLightParams::operator==(const CyclesLightParams& other) const
 		spot_angle == other.spot_angle &&
 		spot_smooth == other.spot_smooth &&
 		size == other.size &&
+		size_u == other.size_u &&
+		size_v == other.size_v &&
+		ies_file == other.ies_file &&
+		use_mis_override == other.use_mis_override &&
+		use_mis == other.use_mis &&
+		samples == other.samples &&
+		max_bounces == other.max_bounces &&
+		use_diffuse == other.use_diffuse &&
+		use_glossy == other.use_glossy &&
+		use_transmission == other.use_transmission &&
 		type == other.type &&
 		intensity == other.intensity &&
 		color == other.color &&
 		shadows_enabled == other.shadows_enabled &&
-		errored == other.errored;
+		errored == other.errored &&
+		warning_string == other.warning_string;
 }
 
 bool CyclesLightParams::operator!=(const CyclesLightParams& other) const
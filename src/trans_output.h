@@ -139,6 +139,9 @@ public:
 	const int v2;
 	const int shader_mtl_index;
 	const bool smooth;
+
+	bool operator==(const TriangleFace& other) const;
+	bool operator!=(const TriangleFace& other) const;
 };
 
 class MeshGeometryObj {
@@ -156,6 +159,9 @@ public:
 	// More info needed by ActiveShade only
 	std::vector<unsigned int> uv_channels_present;
 	std::vector<unsigned short> mtl_ids_present;
+
+	bool operator==(const MeshGeometryObj& other) const;
+	bool operator!=(const MeshGeometryObj& other) const;
 };
 
 class CyclesGeomObject {
@@ -170,6 +176,9 @@ public:
 	ccl::Transform tfm;
 	ccl::Transform tfm_post;
 
+	// Transform at every motion step including the center, when non-empty this is used instead of tfm_pre/tfm_post
+	std::vector<ccl::Transform> motion_tfms;
+
 	ccl::uint random_id;
 
 	std::shared_ptr<MeshGeometryObj> mesh_geometry;
@@ -201,13 +210,30 @@ public:
 	float spot_angle = 3.14159f / 4.0f;
 	float spot_smooth = 0.0f;
 	float size = 1.0f;
+	// Dimensions of area shapes along the light's local x and y axes
+	float size_u = 1.0f;
+	float size_v = 1.0f;
 	CyclesLightType type = CyclesLightType::INVALID;
 	float intensity = 1.0f;
 	ccl::float3 color = ccl::make_float3(1.0f, 1.0f, 1.0f);
 	bool shadows_enabled = true;
+	// Full path of the photometric web file, empty if the light has no web distribution
+	std::wstring ies_file;
+
+	// Sampling settings, read from the node's user defined properties
+	// MIS falls back to the render settings unless the node sets it
+	bool use_mis_override = false;
+	bool use_mis = true;
+	int samples = 1;
+	int max_bounces = 1024;
+	bool use_diffuse = true;
+	bool use_glossy = true;
+	bool use_transmission = true;
 
 	bool errored = false;
 	std::wstring error_string;
+	// Set when the light was translated but something about it could not be represented
+	std::wstring warning_string;
 
 	bool operator==(const CyclesLightParams& other) const;
 	bool operator!=(const CyclesLightParams& other) const;
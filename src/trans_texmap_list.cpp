@@ -161,7 +161,7 @@ void CyclesTexmapListTranslator::PostTranslate(const TimeValue /*translationTime
 
 void CyclesTexmapListTranslator::AccumulateStatistics(TranslatorStatistics& /*stats*/) const
 {
-	// Do nothing
+	// TranslatorStatistics has no texmap count, baked texmap memory is logged by the interactive session instead
 }
 
 Interval CyclesTexmapListTranslator::CheckValidity(const TimeValue /*t*/, const Interval& previous_validity) const
@@ -90,7 +90,7 @@ MaxSDK::RenderingAPI::TranslationResult CyclesTexmapTranslator::TranslateKeyfram
 
 void CyclesTexmapTranslator::AccumulateStatistics(MaxSDK::RenderingAPI::TranslatorStatistics& /*stats*/) const
 {
-	// Do nothing
+	// Texmaps are baked after translation, so there is no texture memory to report yet
 }
 
 Interval CyclesTexmapTranslator::CheckValidity(const TimeValue /*t*/, const Interval& /*previous_validity*/) const
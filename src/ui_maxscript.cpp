@@ -340,6 +340,48 @@ static Value* set_point_light_size(Value* const val)
 	return set_float(val, gui_render_params.point_light_size, 0.0f);
 }
 
+////
+// lightUseMis
+////
+
+static Value* get_light_use_mis()
+{
+	return Integer::intern(static_cast<int>(gui_render_params.light_use_mis));
+}
+
+static Value* set_light_use_mis(Value* const val)
+{
+	return set_bool(val, gui_render_params.light_use_mis);
+}
+
+////
+// autoEmissionMis
+////
+
+static Value* get_auto_emission_mis()
+{
+	return Integer::intern(static_cast<int>(gui_render_params.auto_emission_mis));
+}
+
+static Value* set_auto_emission_mis(Value* const val)
+{
+	return set_bool(val, gui_render_params.auto_emission_mis);
+}
+
+////
+// autoEmissionMisThreshold
+////
+
+static Value* get_auto_emission_mis_threshold()
+{
+	return Float::intern(gui_render_params.auto_emission_mis_threshold);
+}
+
+static Value* set_auto_emission_mis_threshold(Value* const val)
+{
+	return set_float(val, gui_render_params.auto_emission_mis_threshold, 0.0f);
+}
+
 ////
 // texmapBakeWidth
 ////
@@ -368,6 +410,20 @@ static Value* set_texmap_bake_height(Value* const val)
 	return set_int(val, gui_render_params.texmap_bake_height, 1);
 }
 
+////
+// texmapBakeScreenSize
+////
+
+static Value* get_texmap_bake_screen_size()
+{
+	return Integer::intern(static_cast<int>(gui_render_params.texmap_bake_screen_size));
+}
+
+static Value* set_texmap_bake_screen_size(Value* const val)
+{
+	return set_bool(val, gui_render_params.texmap_bake_screen_size);
+}
+
 ////
 // deformBlurSamples
 ////
@@ -604,6 +660,20 @@ static Value* set_progressive_refine(Value* const val)
 	return set_bool(val, gui_render_params.use_progressive_refine);
 }
 
+////
+// activeShadeStartDivider
+////
+
+static Value* get_activeshade_start_divider()
+{
+	return Integer::intern(gui_render_params.activeshade_start_divider);
+}
+
+static Value* set_activeshade_start_divider(Value* const val)
+{
+	return set_int(val, gui_render_params.activeshade_start_divider, 1, 16);
+}
+
 ////
 // stereoMode
 ////
@@ -758,6 +828,40 @@ static Value* set_pass_mist_exp(Value* const val)
 	return val;
 }
 
+////
+// perfTraceFormat
+////
+
+static Value* get_perf_trace_format()
+{
+	return Integer::intern(static_cast<int>(gui_render_params.perf_trace_format));
+}
+
+static Value* set_perf_trace_format(Value* const val)
+{
+	const int int_val = val->to_int();
+	if (int_val < 0 || int_val >= static_cast<int>(PerfTraceFormat::TYPE_COUNT)) {
+		return Integer::intern(static_cast<int>(gui_render_params.perf_trace_format));
+	}
+
+	gui_render_params.perf_trace_format = static_cast<PerfTraceFormat>(int_val);
+	return val;
+}
+
+////
+// writeSceneSnapshot
+////
+
+static Value* get_write_scene_snapshot()
+{
+	return Integer::intern(static_cast<int>(gui_render_params.write_scene_snapshot));
+}
+
+static Value* set_write_scene_snapshot(Value* const val)
+{
+	return set_bool(val, gui_render_params.write_scene_snapshot);
+}
+
 void register_maxscript_globals()
 {
 	if (globals_registered) {
@@ -785,8 +889,12 @@ void register_maxscript_globals()
 	define_struct_global(L"misMapSize", L"cyclesRender", get_mis_map_size, set_mis_map_size);
 	define_struct_global(L"skyIntensity", L"cyclesRender", get_sky_intensity, set_sky_intensity);
 	define_struct_global(L"pointLightSize", L"cyclesRender", get_point_light_size, set_point_light_size);
+	define_struct_global(L"lightUseMis", L"cyclesRender", get_light_use_mis, set_light_use_mis);
+	define_struct_global(L"autoEmissionMis", L"cyclesRender", get_auto_emission_mis, set_auto_emission_mis);
+	define_struct_global(L"autoEmissionMisThreshold", L"cyclesRender", get_auto_emission_mis_threshold, set_auto_emission_mis_threshold);
 	define_struct_global(L"texmapBakeWidth", L"cyclesRender", get_texmap_bake_width, set_texmap_bake_width);
 	define_struct_global(L"texmapBakeHeight", L"cyclesRender", get_texmap_bake_height, set_texmap_bake_height);
+	define_struct_global(L"texmapBakeScreenSize", L"cyclesRender", get_texmap_bake_screen_size, set_texmap_bake_screen_size);
 	define_struct_global(L"deformBlurSamples", L"cyclesRender", get_deform_blur_samples, set_deform_blur_samples);
 
 	define_struct_global(L"lightpathMaxBounce", L"cyclesRender", get_lp_max_bounce, set_lp_max_bounce);
@@ -806,6 +914,7 @@ void register_maxscript_globals()
 	define_struct_global(L"tileWidth", L"cyclesRender", get_tile_width, set_tile_width);
 	define_struct_global(L"tileHeight", L"cyclesRender", get_tile_height, set_tile_height);
 	define_struct_global(L"useProgressiveRefine", L"cyclesRender", get_progressive_refine, set_progressive_refine);
+	define_struct_global(L"activeShadeStartDivider", L"cyclesRender", get_activeshade_start_divider, set_activeshade_start_divider);
 
 	define_struct_global(L"stereoMode", L"cyclesRender", get_stereo_mode, set_stereo_mode);
 	define_struct_global(L"stereoInterocularDistance", L"cyclesRender", get_interocular_dist, set_interocular_dist);
@@ -817,5 +926,8 @@ void register_maxscript_globals()
 	define_struct_global(L"passMistDepth", L"cyclesRender", get_pass_mist_depth, set_pass_mist_depth);
 	define_struct_global(L"passMistExponent", L"cyclesRender", get_pass_mist_exp, set_pass_mist_exp);
 
+	define_struct_global(L"perfTraceFormat", L"cyclesRender", get_perf_trace_format, set_perf_trace_format);
+	define_struct_global(L"writeSceneSnapshot", L"cyclesRender", get_write_scene_snapshot, set_write_scene_snapshot);
+
 	globals_registered = true;
 }
@@ -17,6 +17,10 @@
  
 #include "util_cycles_params.h"
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
 #include <render/buffers.h>
 #include <render/session.h>
 
@@ -96,6 +100,20 @@ ccl::SceneParams get_scene_params()
 
 	scene_params.bvh_type = ccl::SceneParams::BVH_STATIC;
 	scene_params.shadingsystem = ccl::SHADINGSYSTEM_SVM;
+	// Particle sphere clouds are built from very short curves, which only appear round with the thick curve shape
+	scene_params.hair_shape = ccl::CURVE_THICK;
 
 	return scene_params;
 }
+
+int get_start_resolution(const Int2 resolution, const int divider)
+{
+	if (divider <= 1) {
+		return INT_MAX;
+	}
+
+	// Cycles halves the image until its area fits in start_resolution squared, so this lands on the power of two at or
+	// above the requested divider
+	const double full_size = std::sqrt(static_cast<double>(resolution.x()) * static_cast<double>(resolution.y()));
+	return std::max(1, static_cast<int>(std::ceil(full_size / divider)));
+}
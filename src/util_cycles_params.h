@@ -40,3 +40,6 @@ namespace ccl {
 ccl::BufferParams get_buffer_params(Int2 buffer_size, std::vector<RenderPassInfo> pass_info = std::vector<RenderPassInfo>{});
 boost::optional<ccl::SessionParams> get_session_params(const CyclesRenderParams& rend_params);
 ccl::SceneParams get_scene_params();
+
+// Returns the SessionParams::start_resolution that makes Cycles begin at 1/divider of the given resolution
+int get_start_resolution(Int2 resolution, int divider);
@@ -90,6 +90,10 @@ enum class CyclesLightType {
 	SPHERE,
 	DIRECT,
 	SPOT,
+	RECTANGLE,
+	DISC,
+	CYLINDER,
+	LINE,
 };
 
 enum class RenderDevice {
@@ -99,6 +103,12 @@ enum class RenderDevice {
 	DEVICE_COUNT,
 };
 
+enum class MeshTangentPolicy {
+	NONE,
+	HOST,
+	MIKKTSPACE,
+};
+
 // Material description enums
 
 enum class DisplacementMethod {
@@ -222,6 +232,13 @@ enum class LogNumberFormat {
 
 // Misc
 
+enum class PerfTraceFormat {
+	NONE,
+	CHROME_JSON,
+	CSV,
+	TYPE_COUNT,
+};
+
 enum class FilmFilterType {
 	BOX,
 	GAUSSIAN,
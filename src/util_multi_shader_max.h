@@ -41,6 +41,9 @@ public:
 
 	std::vector<ccl::Shader*> mesh_shader_vector;
 
+	// True if any shader in mesh_shader_vector reads the UV tangent attribute
+	bool uses_uv_tangents = false;
+
 private:
 	int size;
 
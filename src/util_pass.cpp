@@ -210,3 +210,12 @@ ccl::vector<ccl::Pass> get_ccl_pass_vector(const std::vector<RenderPassInfo>& pa
 
 	return result;
 }
+
+void append_adaptive_sampling_passes(std::vector<RenderPassInfo>& pass_info_vector)
+{
+	// Dummy passes with no attached render element
+	const RenderPassInfo aux_info{ RenderPassType::ADAPTIVE_AUX, ccl::PassType::PASS_ADAPTIVE_AUX_BUFFER, 4, "AdaptiveAuxBuffer", 0 };
+	pass_info_vector.push_back(aux_info);
+	const RenderPassInfo count_info{ RenderPassType::SAMPLE_COUNT, ccl::PassType::PASS_SAMPLE_COUNT, 1, "SampleCount", 0 };
+	pass_info_vector.push_back(count_info);
+}
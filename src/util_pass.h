@@ -55,3 +55,8 @@ public:
  * @brief Converts render pass info from internal format to an array of ccl::Pass.
  */
 ccl::vector<ccl::Pass> get_ccl_pass_vector(const std::vector<RenderPassInfo>& pass_info_vector);
+
+/**
+ * @brief Appends the auxiliary passes Cycles needs when adaptive sampling is enabled.
+ */
+void append_adaptive_sampling_passes(std::vector<RenderPassInfo>& pass_info_vector);
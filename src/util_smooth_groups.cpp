@@ -0,0 +1,199 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#include "util_smooth_groups.h"
+
+#include <cassert>
+
+#include <util/util_tbb.h>
+
+// A vertex can never be split into more pieces than there are smoothing group bits
+static constexpr size_t MAX_SMOOTH_ENTRIES = 32;
+
+// Below this many vertices thread startup costs more than it saves
+static constexpr size_t MIN_PARALLEL_VERTS = 16384;
+
+/**
+ * @brief Fixed-capacity list of merged smoothing groups for a single vertex.
+ *
+ * Merging follows the exact order of the original std::list based implementation so vertex numbering is unchanged.
+ */
+class SmoothGroupList {
+public:
+	size_t size = 0;
+	std::uint32_t groups[MAX_SMOOTH_ENTRIES];
+
+	void add(const std::uint32_t smooth_group)
+	{
+		if (smooth_group == 0) {
+			return;
+		}
+
+		for (size_t i = 0; i < size; ++i) {
+			if (groups[i] & smooth_group) {
+				groups[i] |= smooth_group;
+				return;
+			}
+		}
+
+		assert(size < MAX_SMOOTH_ENTRIES);
+		groups[size++] = smooth_group;
+	}
+
+	void collapse()
+	{
+		for (size_t outer = 0; outer < size; ++outer) {
+			size_t inner = 0;
+			while (inner < size) {
+				if (inner == outer) {
+					++inner;
+					continue;
+				}
+
+				if (groups[outer] & groups[inner]) {
+					groups[outer] |= groups[inner];
+					erase(inner);
+					if (inner < outer) {
+						--outer;
+					}
+				}
+				else {
+					++inner;
+				}
+			}
+		}
+	}
+
+	// Returns the index of the first group overlapping smooth_group, or -1 if there is none
+	int find(const std::uint32_t smooth_group) const
+	{
+		for (size_t i = 0; i < size; ++i) {
+			if (groups[i] & smooth_group) {
+				return static_cast<int>(i);
+			}
+		}
+		return -1;
+	}
+
+private:
+	void erase(const size_t index)
+	{
+		for (size_t i = index + 1; i < size; ++i) {
+			groups[i - 1] = groups[i];
+		}
+		--size;
+	}
+};
+
+template <typename Func>
+static void for_each_range(const size_t count, const bool use_parallel, const Func& func)
+{
+	if (use_parallel && count >= MIN_PARALLEL_VERTS) {
+		ccl::parallel_for(ccl::blocked_range<size_t>(0, count), [&func](const ccl::blocked_range<size_t>& range) {
+			func(range.begin(), range.end());
+		});
+	}
+	else {
+		func(0, count);
+	}
+}
+
+SmoothGroupSplit split_smoothing_groups(
+	const size_t num_input_verts,
+	const size_t num_faces,
+	const int* const face_verts,
+	const std::uint32_t* const face_smooth_groups,
+	const bool use_parallel)
+{
+	const size_t num_corners = num_faces * 3;
+
+	SmoothGroupSplit result;
+	result.corner_verts.resize(num_corners);
+
+	// Bucket corners by vertex with a counting sort, corners stay in face order within each bucket
+	std::vector<int> vert_corner_offsets(num_input_verts + 1, 0);
+	for (size_t i = 0; i < num_corners; ++i) {
+		++vert_corner_offsets[face_verts[i] + 1];
+	}
+	for (size_t i = 0; i < num_input_verts; ++i) {
+		vert_corner_offsets[i + 1] += vert_corner_offsets[i];
+	}
+
+	std::vector<int> vert_corners(num_corners);
+	{
+		std::vector<int> fill_pos(vert_corner_offsets.begin(), vert_corner_offsets.end() - 1);
+		for (size_t i = 0; i < num_corners; ++i) {
+			vert_corners[fill_pos[face_verts[i]]++] = static_cast<int>(i);
+		}
+	}
+
+	// For each vertex, merge smoothing groups and record which merged group each corner belongs to
+	// new_vert_offsets[v] temporarily holds the number of extra vertices needed by v
+	std::vector<int> corner_group(num_corners);
+	std::vector<int> new_vert_offsets(num_input_verts + 1, 0);
+	for_each_range(num_input_verts, use_parallel, [&](const size_t begin, const size_t end) {
+		for (size_t v = begin; v < end; ++v) {
+			const int corner_begin = vert_corner_offsets[v];
+			const int corner_end = vert_corner_offsets[v + 1];
+
+			SmoothGroupList list;
+			for (int c = corner_begin; c < corner_end; ++c) {
+				list.add(face_smooth_groups[vert_corners[c] / 3]);
+			}
+			list.collapse();
+
+			for (int c = corner_begin; c < corner_end; ++c) {
+				const int corner = vert_corners[c];
+				corner_group[corner] = list.find(face_smooth_groups[corner / 3]);
+			}
+
+			new_vert_offsets[v + 1] = list.size > 1 ? static_cast<int>(list.size - 1) : 0;
+		}
+	});
+
+	// Prefix sum gives the first new vertex index for each original vertex
+	for (size_t i = 0; i < num_input_verts; ++i) {
+		new_vert_offsets[i + 1] += new_vert_offsets[i];
+	}
+	const size_t added_verts = static_cast<size_t>(new_vert_offsets[num_input_verts]);
+	result.total_verts = num_input_verts + added_verts;
+	result.duplicated_from.resize(added_verts);
+
+	for_each_range(num_input_verts, use_parallel, [&](const size_t begin, const size_t end) {
+		for (size_t v = begin; v < end; ++v) {
+			for (int i = new_vert_offsets[v]; i < new_vert_offsets[v + 1]; ++i) {
+				result.duplicated_from[i] = static_cast<int>(v);
+			}
+		}
+	});
+
+	// Group 0 and corners with no matching group keep the original vertex
+	for_each_range(num_corners, use_parallel, [&](const size_t begin, const size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			const int orig_vert = face_verts[i];
+			const int group = corner_group[i];
+			if (group > 0) {
+				result.corner_verts[i] = static_cast<int>(num_input_verts) + new_vert_offsets[orig_vert] + group - 1;
+			}
+			else {
+				result.corner_verts[i] = orig_vert;
+			}
+		}
+	});
+
+	return result;
+}
@@ -0,0 +1,58 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#pragma once
+
+/**
+ * @file
+ * @brief Defines functions used to split mesh vertices along smoothing group boundaries.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Result of splitting a triangle mesh by smoothing group.
+ *
+ * Vertices [0, num_input_verts) keep their original index, every vertex added after that is a copy of the input
+ * vertex listed in duplicated_from.
+ */
+class SmoothGroupSplit {
+public:
+	size_t total_verts = 0;
+
+	// Output vertex index for each face corner, 3 per face
+	std::vector<int> corner_verts;
+
+	// Source vertex index for each output vertex at or after num_input_verts
+	std::vector<int> duplicated_from;
+};
+
+/**
+ * @brief Duplicates vertices that are shared by faces with no smoothing group in common.
+ *
+ * All work is done in a handful of flat arrays sized to the mesh, no allocations are made per vertex.
+ * When use_parallel is set the per-vertex and per-corner passes are split across threads, output is identical either way.
+ */
+SmoothGroupSplit split_smoothing_groups(
+	size_t num_input_verts,
+	size_t num_faces,
+	const int* face_verts,
+	const std::uint32_t* face_smooth_groups,
+	bool use_parallel = false
+);
@@ -0,0 +1,89 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#include "util_sphere_cloud.h"
+
+#include <cassert>
+
+#include <render/attribute.h>
+#include <render/hair.h>
+
+// Distance between the two keys of a sphere relative to its radius, small enough that the result is visually a sphere
+constexpr float KEY_OFFSET_FACTOR = 1.0e-3f;
+
+ccl::Hair* get_sphere_cloud(
+	const std::vector<ccl::float3>& centers,
+	const std::vector<float>& radii,
+	const std::vector<float>& random_values,
+	ccl::Shader* const shader,
+	const size_t motion_steps,
+	const std::vector<ccl::float3>& motion_centers)
+{
+	assert(centers.size() == radii.size());
+	assert(centers.size() == random_values.size());
+	assert(motion_steps == 0 || motion_centers.size() == centers.size() * motion_steps);
+
+	ccl::Hair* const result = new ccl::Hair();
+
+	ccl::array<ccl::Node*> used_shaders;
+	used_shaders.push_back_slow(shader);
+	result->set_used_shaders(used_shaders);
+
+	const size_t sphere_count = centers.size();
+	result->reserve_curves(static_cast<int>(sphere_count), static_cast<int>(2 * sphere_count));
+	for (size_t i = 0; i < sphere_count; i++) {
+		const ccl::float3 offset = ccl::make_float3(0.0f, 0.0f, radii[i] * KEY_OFFSET_FACTOR);
+		result->add_curve_key(centers[i] - offset, radii[i]);
+		result->add_curve_key(centers[i] + offset, radii[i]);
+		result->add_curve(static_cast<int>(2 * i), 0);
+	}
+
+	ccl::Attribute* const attr_random = result->attributes.add(ccl::ATTR_STD_CURVE_RANDOM);
+	float* const random_data = attr_random->data_float();
+	for (size_t i = 0; i < sphere_count; i++) {
+		random_data[i] = random_values[i];
+	}
+
+	if (motion_steps > 1) {
+		result->set_use_motion_blur(true);
+		result->set_motion_steps(static_cast<ccl::uint>(motion_steps));
+
+		// The motion attribute stores every step except the center, which is the regular key position
+		const size_t center_step = motion_steps / 2;
+		const size_t key_count = 2 * sphere_count;
+		ccl::Attribute* const attr_motion = result->attributes.add(ccl::ATTR_STD_MOTION_VERTEX_POSITION);
+		ccl::float4* const motion_data = attr_motion->data_float4();
+		size_t motion_data_step = 0;
+		for (size_t step = 0; step < motion_steps; step++) {
+			if (step == center_step) {
+				continue;
+			}
+			ccl::float4* const step_data = motion_data + motion_data_step * key_count;
+			for (size_t i = 0; i < sphere_count; i++) {
+				const ccl::float3 center = motion_centers[i * motion_steps + step];
+				const ccl::float3 offset = ccl::make_float3(0.0f, 0.0f, radii[i] * KEY_OFFSET_FACTOR);
+				step_data[2 * i + 0] = ccl::float3_to_float4(center - offset);
+				step_data[2 * i + 1] = ccl::float3_to_float4(center + offset);
+				step_data[2 * i + 0].w = radii[i];
+				step_data[2 * i + 1].w = radii[i];
+			}
+			++motion_data_step;
+		}
+	}
+
+	return result;
+}
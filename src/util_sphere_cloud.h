@@ -0,0 +1,51 @@
+/* 
+ * This file is part of Cycles for Max. (c) Jeffrey Witthuhn
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+ 
+#pragma once
+
+/**
+ * @file
+ * @brief Defines the function get_sphere_cloud.
+ */
+
+#include <cstddef>
+#include <vector>
+
+#include <util/util_types.h>
+
+namespace ccl {
+	class Hair;
+	class Shader;
+}
+
+/**
+ * @brief Returns a single cycles geometry holding one sphere for each entry in centers.
+ *
+ * Cycles has no point primitive, so each sphere is a curve with two keys placed almost on top of each other. A thick
+ * curve is the sweep of a sphere along its keys, which makes such a curve render as a sphere of the given radius.
+ * random_values are written to the curve random attribute so the hair info node can vary shading per sphere.
+ * If motion_steps is non-zero, motion_centers must hold motion_steps positions for each sphere, including the
+ * center step.
+ */
+ccl::Hair* get_sphere_cloud(
+	const std::vector<ccl::float3>& centers,
+	const std::vector<float>& radii,
+	const std::vector<float>& random_values,
+	ccl::Shader* shader,
+	size_t motion_steps = 0,
+	const std::vector<ccl::float3>& motion_centers = std::vector<ccl::float3>()
+);
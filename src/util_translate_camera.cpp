@@ -17,6 +17,7 @@
  
 #include "util_translate_camera.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include <render/camera.h>
@@ -572,3 +573,26 @@ void apply_camera_params(const CyclesCameraParams& camera_params, const CyclesRe
 	camera.set_motion_position(ccl::Camera::MotionPosition::MOTION_POSITION_CENTER);
 	camera.set_rolling_shutter_type(ccl::Camera::RollingShutterType::ROLLING_SHUTTER_NONE);
 }
+
+boost::optional<float> get_projected_size(const CyclesCameraParams& camera_params, const Box3& world_bbox)
+{
+	if (camera_params.camera_type != ccl::CAMERA_PERSPECTIVE || world_bbox.IsEmpty()) {
+		return boost::none;
+	}
+
+	const CyclesPerspOrthoCamParams& persp_params = camera_params.params_union.persp_ortho_params;
+	const float resolution = static_cast<float>(std::max(camera_params.final_resolution.x(), camera_params.final_resolution.y()));
+
+	const Point3 center = world_bbox.Center();
+	const float radius = 0.5f * Length(world_bbox.Width());
+	const ccl::float3 camera_pos = ccl::transform_get_column(&persp_params.transform, 3);
+	const float distance = ccl::len(ccl::make_float3(center.x, center.y, center.z) - camera_pos);
+
+	if (distance <= radius) {
+		// Camera is inside the bounding sphere, it may fill the whole view
+		return resolution;
+	}
+
+	const float view_width = 2.0f * distance * std::tan(0.5f * persp_params.fov);
+	return std::min(resolution, resolution * (2.0f * radius) / view_width);
+}
@@ -38,6 +38,7 @@ namespace MaxSDK {
 	}
 }
 
+class Box3;
 class CyclesRenderParams;
 
 /**
@@ -45,6 +46,13 @@ class CyclesRenderParams;
  */
 boost::optional<CyclesCameraParams> get_camera_params(const MaxSDK::RenderingAPI::IRenderSessionContext& session_context, TimeValue t, StereoscopyType stereo_type);
 
+/**
+ * @brief Returns the approximate size in pixels of a world-space bounding box as seen by a perspective camera.
+ *
+ * This is an estimate based on the bounding sphere of the box, it returns nothing for non-perspective cameras.
+ */
+boost::optional<float> get_projected_size(const CyclesCameraParams& camera_params, const Box3& world_bbox);
+
 /**
  * @brief Applies the given camera parameters to the ccl::Camera.
  */
@@ -17,17 +17,18 @@
  
 #include "util_translate_geometry.h"
 
-#include <list>
+#include <algorithm>
 #include <random>
 #include <set>
 
 #include <render/mesh.h>
 #include <render/object.h>
 #include <render/scene.h>
+#include <util/util_hash.h>
+#include <util/util_transform.h>
 #include <RenderingAPI/Translator/Helpers/IMeshFlattener.h>
 
 #include <inode.h>
-#include <IParticleObjectExt.h>
 #include <mesh.h>
 #include <modstack.h>
 
@@ -37,7 +38,9 @@
 #include "rend_logger.h"
 #include "rend_shader_manager.h"
 #include "util_debug.h"
+#include "util_enums.h"
 #include "util_matrix_max.h"
+#include "util_smooth_groups.h"
 
 #include <thread>
 
@@ -49,15 +52,9 @@ constexpr int ITERATIONS_PER_UI_UPDATE = 180000;
 
 static bool is_node_shadow_catcher(INode* const node, const TimeValue t)
 {
-	if (node->GetObjectRef()->SuperClassID() == GEN_DERIVOB_CLASS_ID) {
-		IDerivedObject* const derived_object = dynamic_cast<IDerivedObject*>(node->GetObjectRef());
-		for (int i = 0; i < derived_object->NumModifiers(); i++) {
-			Modifier* const this_modifier = derived_object->GetModifier(i);
-			if (this_modifier != nullptr && this_modifier->ClassID() == CYCLES_MOD_PROPERTIES_CLASS) {
-				CyclesPropertiesMod* const cycles_properties = dynamic_cast<CyclesPropertiesMod*>(this_modifier);
-				return cycles_properties->GetIsShadowCatcher(t);
-			}
-		}
+	CyclesPropertiesMod* const cycles_properties = get_node_properties_mod(node);
+	if (cycles_properties != nullptr) {
+		return cycles_properties->GetIsShadowCatcher(t);
 	}
 	return false;
 }
@@ -307,80 +304,6 @@ std::shared_ptr<MeshGeometryObj> get_mesh_geometry(INode* const node, View& view
 	return result;
 }
 
-class SmoothGroupVert {
-public:
-	SmoothGroupVert(const DWORD smooth_group, const DWORD new_vert) : smooth_group{ smooth_group }, new_vert{ new_vert } {}
-
-	DWORD smooth_group;
-	DWORD new_vert;
-};
-
-class MultiVertex {
-public:
-	MultiVertex(unsigned int vert_index) : vert_index{ vert_index } {}
-
-	int get_vert_index(DWORD smooth_group);
-	void add_smooth_vert(DWORD smooth_group, DWORD vertex);
-	void collapse_list();
-
-	typedef std::list<SmoothGroupVert>::iterator list_iter;
-
-	std::list<SmoothGroupVert> smooth_verts;
-	unsigned int vert_index;
-};
-
-int MultiVertex::get_vert_index(DWORD smooth_group)
-{
-	for (SmoothGroupVert& this_vert : smooth_verts) {
-		if (smooth_group & this_vert.smooth_group) {
-			return this_vert.new_vert;
-		}
-	}
-
-	// Use default vert if no smooth groups match
-	return vert_index;
-}
-
-void MultiVertex::add_smooth_vert(DWORD smooth_group, DWORD vertex)
-{
-	if (smooth_group == 0) {
-		return;
-	}
-
-	for (SmoothGroupVert& this_vert : smooth_verts) {
-		if (smooth_group & this_vert.smooth_group) {
-			this_vert.smooth_group |= smooth_group;
-			return;
-		}
-	}
-
-	smooth_verts.push_back(SmoothGroupVert{ smooth_group, vertex });
-}
-
-void MultiVertex::collapse_list()
-{
-	// After all vertex information has been added, we must look over the list and merge compatible entries
-	// This operation is O(n^2) but n is guaranteed to be sufficiently small that this is not a problem (<= 32)
-	for (list_iter iter = smooth_verts.begin(); iter != smooth_verts.end(); ++iter) {
-		// For each element in the list, compare it to each subsequent element in the list and see if a merge is possible
-		list_iter inner_iter = smooth_verts.begin();
-		while (inner_iter != smooth_verts.end()) {
-			if (inner_iter == iter) { // Don't compare against self
-				++inner_iter;
-				continue;
-			}
-
-			if (iter->smooth_group & inner_iter->smooth_group) {
-				iter->smooth_group |= inner_iter->smooth_group;
-				smooth_verts.erase(inner_iter++);
-			}
-			else {
-				++inner_iter;
-			}
-		}
-	}
-}
-
 std::shared_ptr<MeshGeometryObj> get_mesh_geometry(Mesh* mesh, const TimeValue /*t*/, const std::vector<int>& /*mblur_sample_ticks*/, const int mtl_id_override, const std::function<void()> ui_callback)
 {
 	const std::unique_ptr<LoggerInterface> logger = global_log_manager.new_logger(L"UtilGeomGet2", false, true);
@@ -388,52 +311,28 @@ std::shared_ptr<MeshGeometryObj> get_mesh_geometry(Mesh* mesh, const TimeValue /
 
 	const std::shared_ptr<MeshGeometryObj> result = std::make_shared<MeshGeometryObj>();
 
-	std::vector<MultiVertex> multi_verts;
-	multi_verts.resize(mesh->numVerts, MultiVertex(0));
-	for (int i = 0; i < multi_verts.size(); ++i) {
-		multi_verts[i] = MultiVertex(i);
-		MAYBE_UI_CALLBACK(i)
-	}
-
-	// Calculate which verts need to be duplicated for smoothing groups
+	// Gather face data into flat arrays for the smoothing group splitter
+	std::vector<int> face_verts(3 * static_cast<size_t>(mesh->numFaces));
+	std::vector<std::uint32_t> face_smooth_groups(mesh->numFaces);
 	for (int i = 0; i < mesh->numFaces; ++i) {
 		// Face type always represents a triangle
-		Face* face = mesh->faces + i;
-		// For each of the three verts, add this smooth group
-		for (int j = 0; j < 3; ++j) {
-			multi_verts[face->v[j]].add_smooth_vert(face->smGroup, face->v[j]);
-		}
+		const Face* const face = mesh->faces + i;
+		face_verts[3 * i + 0] = static_cast<int>(face->v[0]);
+		face_verts[3 * i + 1] = static_cast<int>(face->v[1]);
+		face_verts[3 * i + 2] = static_cast<int>(face->v[2]);
+		face_smooth_groups[i] = face->smGroup;
 		MAYBE_UI_CALLBACK(i)
 	}
 
-	// total_verts will be updated as we add new verts
-	int total_verts = mesh->numVerts;
-	{
-		int i = 0;
-		for (MultiVertex& multi_vert : multi_verts) {
-			// Collapse
-			multi_vert.collapse_list();
-
-			// Populate new vert indices
-			MultiVertex::list_iter normal_iter = multi_vert.smooth_verts.begin();
-			// Skip this vert if the normal list is empty
-			if (normal_iter == multi_vert.smooth_verts.end()) {
-				continue;
-			}
-			++normal_iter;
-			// Starting with the second element, populate new_vert (first one uses original vert)
-			while (normal_iter != multi_vert.smooth_verts.end()) {
-				normal_iter->new_vert = total_verts;
-				++total_verts;
-				++normal_iter;
-			}
+	// Calculate which verts need to be duplicated for smoothing groups
+	const SmoothGroupSplit split = split_smoothing_groups(mesh->numVerts, mesh->numFaces, face_verts.data(), face_smooth_groups.data(), true);
 
-			MAYBE_UI_CALLBACK(i++)
-		}
+	if (ui_callback != nullptr) {
+		ui_callback();
 	}
 
-	result->verts.resize(total_verts, ccl::make_float3(0.0f, 0.0f, 0.0f));
-	
+	result->verts.resize(split.total_verts);
+
 	// Copy original verts into result
 	for (int i = 0; i < mesh->numVerts; ++i) {
 		const Point3& this_vert = mesh->verts[i];
@@ -443,21 +342,9 @@ std::shared_ptr<MeshGeometryObj> get_mesh_geometry(Mesh* mesh, const TimeValue /
 	}
 
 	// Duplicate verts needed for smoothing
-	{
-		int i = 0;
-		for (MultiVertex& multi_vert : multi_verts) {
-			if (multi_vert.smooth_verts.size() < 2) {
-				continue;
-			}
-
-			for (SmoothGroupVert& smooth_vert : multi_vert.smooth_verts) {
-				if (smooth_vert.new_vert == multi_vert.vert_index) {
-					continue;
-				}
-				result->verts[smooth_vert.new_vert] = result->verts[multi_vert.vert_index];
-			}
-			MAYBE_UI_CALLBACK(i++)
-		}
+	for (size_t i = 0; i < split.duplicated_from.size(); ++i) {
+		result->verts[mesh->numVerts + i] = result->verts[split.duplicated_from[i]];
+		MAYBE_UI_CALLBACK(i)
 	}
 
 	// Copy faces, mesh is already triangles
@@ -465,15 +352,10 @@ std::shared_ptr<MeshGeometryObj> get_mesh_geometry(Mesh* mesh, const TimeValue /
 	for (int i = 0; i < mesh->numFaces; ++i) {
 		Face* const face = mesh->faces + i;
 
-		// Original verts for this triangle
-		const int orig_v0 = face->v[0];
-		const int orig_v1 = face->v[1];
-		const int orig_v2 = face->v[2];
-
 		// Altered verts for the cycles triangle
-		const int v0 = multi_verts[orig_v0].get_vert_index(face->smGroup);
-		const int v1 = multi_verts[orig_v1].get_vert_index(face->smGroup);
-		const int v2 = multi_verts[orig_v2].get_vert_index(face->smGroup);
+		const int v0 = split.corner_verts[3 * i + 0];
+		const int v1 = split.corner_verts[3 * i + 1];
+		const int v2 = split.corner_verts[3 * i + 2];
 
 		// Get material
 		int mtl_index;
@@ -546,34 +428,105 @@ CyclesGeomObject get_geom_object(const TimeValue t, INode* const node, const std
 	return result;
 }
 
-CyclesGeomObject get_geom_object(const TimeValue t, INode* const node, IParticleObjectExt* const particle_ext, const int particle_index, const std::vector<int>& /*mblur_sample_ticks*/)
+CyclesGeomObject get_instance_geom_object(const TimeValue t, INode* const node)
 {
-	const std::unique_ptr<LoggerInterface> logger = global_log_manager.new_logger(L"TempGetGeomObject", false, false);
-	*logger << LogCtl::SEPARATOR;
-
 	CyclesGeomObject result;
 
-	// Set up random value based on INode handle
-	// This is used for the "random" output of the object info node
-	{
-		std::mt19937 rng;
-		const unsigned long seed = node->GetHandle() + static_cast<unsigned long>(particle_index);
-		rng.seed(seed);
-		result.random_id = rng();
+	result.is_shadow_catcher = is_node_shadow_catcher(node, t);
+	result.visible_to_camera = node->GetPrimaryVisibility();
+
+	return result;
+}
+
+bool get_node_particle_spheres(const TimeValue t, INode* const node)
+{
+	CyclesPropertiesMod* const cycles_properties = get_node_properties_mod(node);
+	if (cycles_properties != nullptr) {
+		return cycles_properties->GetRenderParticlesAsSpheres(t);
 	}
+	return false;
+}
 
-	const Matrix3 part_tfm = *(particle_ext->GetParticleTMByIndex(particle_index));
+ccl::uint get_instance_random_id(const ULONG node_handle, const int instance_index)
+{
+	// Seeding a mt19937 for every instance is far too slow for large particle systems
+	return ccl::hash_uint2(static_cast<ccl::uint>(node_handle), static_cast<ccl::uint>(instance_index));
+}
 
-	result.tfm = cycles_transform_from_max_matrix(part_tfm);
-	result.tfm_pre = result.tfm;
-	result.tfm_post = result.tfm;
+std::vector<int> get_motion_step_ticks(const std::vector<int>& mblur_sample_ticks)
+{
+	std::vector<int> result;
+	if (mblur_sample_ticks.size() == 0) {
+		return result;
+	}
 
-	result.is_shadow_catcher = is_node_shadow_catcher(node, t);
-	result.visible_to_camera = node->GetPrimaryVisibility();
+	result = mblur_sample_ticks;
+	result.push_back(0);
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
 
 	return result;
 }
 
+void get_particle_motion_tfms(
+	const Matrix3& tm,
+	const Point3& velocity,
+	const AngAxis& spin,
+	const std::vector<int>& motion_step_ticks,
+	ccl::Transform* const motion_tfms_out)
+{
+	const bool has_spin = spin.angle != 0.0f && spin.axis != Point3::Origin;
+	Matrix3 rotation_scale = tm;
+	rotation_scale.NoTrans();
+
+	for (size_t i = 0; i < motion_step_ticks.size(); i++) {
+		const float step_ticks = static_cast<float>(motion_step_ticks[i]);
+		Matrix3 step_tm = rotation_scale;
+		if (has_spin) {
+			// Spin is about the particle's own axes, so it must be applied before the particle's rotation and scale
+			Point3 spin_axis = spin.axis;
+			step_tm = RotAngleAxisMatrix(spin_axis, spin.angle * step_ticks) * rotation_scale;
+		}
+		step_tm.SetTrans(tm.GetTrans() + velocity * step_ticks);
+		motion_tfms_out[i] = cycles_transform_from_max_matrix(step_tm);
+	}
+}
+
+void get_interpolated_motion_tfms(
+	const Matrix3& tm_start,
+	const Matrix3& tm_end,
+	const size_t motion_steps,
+	ccl::Transform* const motion_tfms_out)
+{
+	const ccl::Transform endpoints[2] = {
+		cycles_transform_from_max_matrix(tm_start),
+		cycles_transform_from_max_matrix(tm_end),
+	};
+	ccl::DecomposedTransform decomposed[2];
+	ccl::transform_motion_decompose(decomposed, endpoints, 2);
+
+	for (size_t i = 0; i < motion_steps; i++) {
+		const float time = (motion_steps > 1) ? static_cast<float>(i) / static_cast<float>(motion_steps - 1) : 0.5f;
+		ccl::transform_motion_array_interpolate(motion_tfms_out + i, decomposed, 2, time);
+	}
+}
+
+static MeshTangentPolicy get_mesh_tangent_policy(const MeshGeometryObj& mesh_geometry, const MaxMultiShaderHelper& ms_helper)
+{
+	if (ms_helper.uses_uv_tangents == false || mesh_geometry.uvw_verts.size() == 0) {
+		return MeshTangentPolicy::NONE;
+	}
+
+	// Host tangents are only usable when the flattener produced one for every corner
+	if (mesh_geometry.uvw_tangents.size() == mesh_geometry.uvw_verts.size() &&
+		mesh_geometry.uvw_tangent_signs.size() == mesh_geometry.uvw_verts.size())
+	{
+		return MeshTangentPolicy::HOST;
+	}
+
+	return MeshTangentPolicy::MIKKTSPACE;
+}
+
 static void mesh_thread_func(ccl::Mesh* const mesh, volatile bool* const complete)
 {
 	const std::unique_ptr<LoggerInterface> logger = global_log_manager.new_logger(L"UtilGeomThread", false, true);
@@ -663,10 +616,12 @@ ccl::Mesh* get_ccl_mesh(
 		}
 	}
 
+	const MeshTangentPolicy tangent_policy = get_mesh_tangent_policy(*mesh_geometry, ms_helper);
+
 	*logger << "Copying tangents..." << LogCtl::WRITE_LINE;
 
 	// Copy tangents
-	if (mesh_geometry->uvw_verts.size() > 0) {
+	if (tangent_policy == MeshTangentPolicy::HOST) {
 		ccl::Attribute* const attribute_uv_tangent = ccl_mesh->attributes.add(ccl::AttributeStandard::ATTR_STD_UV_TANGENT);
 		ccl::float3* const uv_tangent_ptr = attribute_uv_tangent->data_float3();
 		ccl::Attribute* const attribute_uv_tangent_sign = ccl_mesh->attributes.add(ccl::AttributeStandard::ATTR_STD_UV_TANGENT_SIGN);
@@ -714,6 +669,12 @@ ccl::Mesh* get_ccl_mesh(
 		ccl_mesh->set_used_shaders(shaders);
 	}
 
+	if (tangent_policy != MeshTangentPolicy::MIKKTSPACE) {
+		// Cycles will generate any normals it needs during the device update
+		*logger << "Tangent calculation not needed" << LogCtl::WRITE_LINE;
+		return ccl_mesh;
+	}
+
 	*logger << "Beginning to calculate tangents" << LogCtl::WRITE_LINE;
 
 	// Calculate tangents and normals in a separate thread so we can keep updating the UI from here
@@ -746,12 +707,12 @@ ccl::Mesh* get_ccl_mesh(
 }
 
 ccl::Object* get_ccl_object(
-	const CyclesGeomObject geom_object,
-	ccl::Mesh* const ccl_mesh )
+	const CyclesGeomObject& geom_object,
+	ccl::Geometry* const ccl_geometry )
 {
 	ccl::Object* const result = new ccl::Object();
 	result->set_random_id(geom_object.random_id);
-	result->set_geometry(ccl_mesh);
+	result->set_geometry(ccl_geometry);
 	result->set_tfm(geom_object.tfm);
 	result->set_is_shadow_catcher(geom_object.is_shadow_catcher);
 
@@ -760,7 +721,12 @@ ccl::Object* get_ccl_object(
 		result->set_visibility(result->get_visibility() & (~ccl::PATH_RAY_CAMERA));
 	}
 
-	if (geom_object.use_object_motion_blur) {
+	if (geom_object.motion_tfms.size() > 0) {
+		ccl::array<ccl::Transform>& motion = result->get_motion();
+		motion.resize(geom_object.motion_tfms.size());
+		std::copy(geom_object.motion_tfms.begin(), geom_object.motion_tfms.end(), motion.data());
+	}
+	else if (geom_object.use_object_motion_blur) {
 		// TODO: Make this use an arbitrary number of samples
 		ccl::array<ccl::Transform>& motion = result->get_motion();
 		motion.resize(3);
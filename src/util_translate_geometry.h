@@ -32,13 +32,13 @@
 #include "trans_output.h"
 
 namespace ccl {
+	class Geometry;
 	class Mesh;
 	class Object;
 	class Shader;
 }
 
 class INode;
-class IParticleObjectExt;
 class MaxMultiShaderHelper;
 class MaxShaderManager;
 class Mesh;
@@ -60,9 +60,52 @@ std::shared_ptr<MeshGeometryObj> get_mesh_geometry(Mesh* mesh, TimeValue t, cons
 CyclesGeomObject get_geom_object(TimeValue t, INode* node, const std::vector<int>& mblur_sample_ticks);
 
 /**
- * @brief Returns a CyclesGeomObject equivalent to the particle index. This will not have any attached geometry.
+ * @brief Returns a CyclesGeomObject holding the properties shared by every instance generated by a node.
+ *
+ * Used for particle systems, the caller is expected to fill in the transform and random id of each instance.
+ */
+CyclesGeomObject get_instance_geom_object(TimeValue t, INode* node);
+
+/**
+ * @brief Returns true if a node's Cycles properties modifier requests its particles be rendered as spheres.
+ */
+bool get_node_particle_spheres(TimeValue t, INode* node);
+
+/**
+ * @brief Returns the random id for one instance generated by a node, this is a cheap hash of the node handle and index.
+ */
+ccl::uint get_instance_random_id(ULONG node_handle, int instance_index);
+
+/**
+ * @brief Returns the tick offset of every object motion step relative to the frame time, including the center step.
+ *
+ * Returns an empty vector if motion blur is disabled.
+ */
+std::vector<int> get_motion_step_ticks(const std::vector<int>& mblur_sample_ticks);
+
+/**
+ * @brief Writes one transform per motion step by extrapolating a particle's velocity and spin from its current transform.
+ *
+ * Velocity is in world units per tick, as reported by IParticleObjectExt::GetParticleSpeedByIndex. Spin is in radians per tick
+ * about an axis in the particle's own space.
  */
-CyclesGeomObject get_geom_object(TimeValue t, INode* node, IParticleObjectExt* particle_ext, int particle_index, const std::vector<int>& mblur_sample_ticks);
+void get_particle_motion_tfms(
+	const Matrix3& tm,
+	const Point3& velocity,
+	const AngAxis& spin,
+	const std::vector<int>& motion_step_ticks,
+	ccl::Transform* motion_tfms_out
+);
+
+/**
+ * @brief Writes motion_steps transforms evenly interpolated between the transforms at the start and end of the shutter.
+ */
+void get_interpolated_motion_tfms(
+	const Matrix3& tm_start,
+	const Matrix3& tm_end,
+	size_t motion_steps,
+	ccl::Transform* motion_tfms_out
+);
 
 
 /**
@@ -78,6 +121,6 @@ ccl::Mesh* get_ccl_mesh(
  * @brief Returns a ccl::Object* equivalent to a given input
  */
 ccl::Object* get_ccl_object(
-	CyclesGeomObject geom_object,
-	ccl::Mesh* ccl_mesh
+	const CyclesGeomObject& geom_object,
+	ccl::Geometry* ccl_geometry
 );
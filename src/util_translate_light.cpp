@@ -17,16 +17,20 @@
  
 #include "util_translate_light.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include <render/light.h>
 #include <render/scene.h>
 
+#include <AssetManagement/AssetType.h>
 #include <genlight.h>
+#include <IFileResolutionManager.h>
 #include <lslights.h>
 #include <object.h>
 
 #include "const_classid.h"
+#include "rend_params.h"
 #include "rend_logger.h"
 #include "rend_logger_ext.h"
 #include "rend_shader_manager.h"
@@ -54,10 +58,63 @@ static CyclesLightType from_max_light_type(const int type)
 		return CyclesLightType::SPHERE;
 	case LightscapeLight::SPHERE_TYPE:
 		return CyclesLightType::SPHERE;
+	case LightscapeLight::TARGET_AREA_TYPE:
+	case LightscapeLight::AREA_TYPE:
+		return CyclesLightType::RECTANGLE;
+	case LightscapeLight::TARGET_DISC_TYPE:
+	case LightscapeLight::DISC_TYPE:
+		return CyclesLightType::DISC;
+	case LightscapeLight::TARGET_CYLINDER_TYPE:
+	case LightscapeLight::CYLINDER_TYPE:
+		return CyclesLightType::CYLINDER;
+	case LightscapeLight::TARGET_LINEAR_TYPE:
+	case LightscapeLight::LINEAR_TYPE:
+		return CyclesLightType::LINE;
 	}
 	return CyclesLightType::INVALID;
 }
 
+static bool is_area_light_type(const CyclesLightType type)
+{
+	switch (type) {
+	case CyclesLightType::RECTANGLE:
+	case CyclesLightType::DISC:
+	case CyclesLightType::CYLINDER:
+	case CyclesLightType::LINE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Reads per-light sampling settings from the node's user defined properties
+// Lights can't hold modifiers, so these are set from the User Defined tab of Object Properties or with setUserProp
+static void read_light_user_props(INode* const node, CyclesLightParams& params)
+{
+	BOOL bool_value = FALSE;
+	int int_value = 0;
+
+	if (node->GetUserPropBool(_T("cycles_use_mis"), bool_value)) {
+		params.use_mis_override = true;
+		params.use_mis = bool_value != FALSE;
+	}
+	if (node->GetUserPropInt(_T("cycles_samples"), int_value)) {
+		params.samples = std::min(std::max(int_value, 1), 4096);
+	}
+	if (node->GetUserPropInt(_T("cycles_max_bounces"), int_value)) {
+		params.max_bounces = std::min(std::max(int_value, 0), 1024);
+	}
+	if (node->GetUserPropBool(_T("cycles_use_diffuse"), bool_value)) {
+		params.use_diffuse = bool_value != FALSE;
+	}
+	if (node->GetUserPropBool(_T("cycles_use_glossy"), bool_value)) {
+		params.use_glossy = bool_value != FALSE;
+	}
+	if (node->GetUserPropBool(_T("cycles_use_transmission"), bool_value)) {
+		params.use_transmission = bool_value != FALSE;
+	}
+}
+
 static bool is_fstorm_light_class(const Class_ID& class_id)
 {
 	if (class_id == FSTORM_LIGHT_CLASS) {
@@ -129,11 +186,49 @@ CyclesLightParams get_light_params(INode* const node, Object* const object, cons
 	}
 
 	if (LightscapeLight* const ls_light = dynamic_cast<LightscapeLight*>(object)) {
+		// Photometric shapes have their width along local x and their length along local y
 		if (result.type == CyclesLightType::SPHERE) {
 			result.size = ls_light->GetRadius(t);
 		}
+		else if (result.type == CyclesLightType::RECTANGLE) {
+			result.size_u = ls_light->GetWidth(t);
+			result.size_v = ls_light->GetLength(t);
+		}
+		else if (result.type == CyclesLightType::DISC) {
+			result.size_u = 2.0f * ls_light->GetRadius(t);
+			result.size_v = 2.0f * ls_light->GetRadius(t);
+		}
+		else if (result.type == CyclesLightType::CYLINDER) {
+			result.size_u = 2.0f * ls_light->GetRadius(t);
+			result.size_v = ls_light->GetLength(t);
+		}
+		else if (result.type == CyclesLightType::LINE) {
+			result.size_v = ls_light->GetLength(t);
+		}
+		*logger << "shape size: " << result.size_u << ", " << result.size_v << LogCtl::WRITE_LINE;
+
+		if (ls_light->GetDistribution() == LightscapeLight::WEB_DIST) {
+			const MCHAR* const web_file = ls_light->GetWebFileName();
+			if (web_file != nullptr && web_file[0] != L'\0') {
+				const MSTR full_path = IFileResolutionManager::GetInstance()->GetFullFilePath(web_file, MaxSDK::AssetManagement::kPhotometricAsset);
+				result.ies_file = full_path.isNull() ? std::wstring(web_file) : std::wstring(full_path.data());
+				*logger << "web file: " << result.ies_file.c_str() << LogCtl::WRITE_LINE;
+
+				// The IES node is always evaluated in the light's own orientation, so web rotation can't be reproduced
+				const float web_rotate_x = ls_light->GetWebRotateX();
+				const float web_rotate_y = ls_light->GetWebRotateY();
+				const float web_rotate_z = ls_light->GetWebRotateZ();
+				if (web_rotate_x != 0.0f || web_rotate_y != 0.0f || web_rotate_z != 0.0f) {
+					result.warning_string = std::wstring(L"Web rotation is not supported and will be ignored for light: ") + node->GetName();
+					*logger << LogLevel::WARN << "ignoring web rotation: " << web_rotate_x << ", " << web_rotate_y << ", " << web_rotate_z << LogCtl::WRITE_LINE;
+				}
+			}
+		}
 	}
 
+	read_light_user_props(node, result);
+	*logger << "mis override: " << result.use_mis_override << " mis: " << result.use_mis << " samples: " << result.samples << LogCtl::WRITE_LINE;
+
 	*logger << "building result..." << LogCtl::WRITE_LINE;
 
 	result.intensity = light_state.intens * 61000.0f;
@@ -196,7 +291,7 @@ static ccl::Light* new_light()
 	return result;
 }
 
-void add_light_to_scene(ccl::Scene* const scene, const std::unique_ptr<MaxShaderManager>& shader_manager, const CyclesLightParams light_params, const float point_light_size)
+void add_light_to_scene(ccl::Scene* const scene, const std::unique_ptr<MaxShaderManager>& shader_manager, const CyclesLightParams light_params, const CyclesRenderParams& rend_params)
 {
 	const std::unique_ptr<LoggerInterface> logger = global_log_manager.new_logger(L"UtilLightAdd", false, true);
 	*logger << LogCtl::SEPARATOR;
@@ -213,7 +308,7 @@ void add_light_to_scene(ccl::Scene* const scene, const std::unique_ptr<MaxShader
 		light_intensity /= 61000.0f;
 	}
 
-	const int light_shader_index = shader_manager->get_light_shader(light_params.color, light_intensity);
+	const int light_shader_index = shader_manager->get_light_shader(light_params.color, light_intensity, light_params.ies_file);
 	ccl::Light* const light = new_light();
 	light->set_shader(scene->shaders[light_shader_index]);
 
@@ -223,7 +318,7 @@ void add_light_to_scene(ccl::Scene* const scene, const std::unique_ptr<MaxShader
 
 	if (light_params.type == CyclesLightType::POINT) {
 		light->set_light_type(ccl::LightType::LIGHT_POINT);
-		light->set_size(point_light_size);
+		light->set_size(rend_params.point_light_size);
 	}
 	else if (light_params.type == CyclesLightType::SPHERE) {
 		light->set_light_type(ccl::LightType::LIGHT_POINT);
@@ -237,13 +332,47 @@ void add_light_to_scene(ccl::Scene* const scene, const std::unique_ptr<MaxShader
 		light->set_light_type(ccl::LightType::LIGHT_SPOT);
 		light->set_spot_angle(light_params.spot_angle);
 		light->set_spot_smooth(light_params.spot_smooth);
-		light->set_size(point_light_size);
+		light->set_size(rend_params.point_light_size);
+	}
+	else if (is_area_light_type(light_params.type)) {
+		// Cycles has no cylinder or line shapes, these become a rectangle facing the same way as the others
+		float size_u = light_params.size_u;
+		if (light_params.type == CyclesLightType::LINE) {
+			// A zero width area light has no area to emit from, so keep lines at least a little wide
+			constexpr float MIN_LINE_LIGHT_WIDTH = 0.001f;
+			size_u = std::max(rend_params.point_light_size, MIN_LINE_LIGHT_WIDTH);
+		}
+
+		// Keep the node's scale by folding it into the sizes rather than the axes
+		const ccl::float3 column_u = ccl::transform_get_column(&(light_params.tfm), 0);
+		const ccl::float3 column_v = ccl::transform_get_column(&(light_params.tfm), 1);
+
+		light->set_light_type(ccl::LightType::LIGHT_AREA);
+		light->set_size(1.0f);
+		light->set_axisu(ccl::safe_normalize(column_u));
+		light->set_sizeu(size_u * ccl::len(column_u));
+		light->set_axisv(ccl::safe_normalize(column_v));
+		light->set_sizev(light_params.size_v * ccl::len(column_v));
+		light->set_round(light_params.type == CyclesLightType::DISC);
+		light->set_use_mis(true);
 	}
 	else {
 		delete light;
 		return;
 	}
 
+	if (light_params.use_mis_override) {
+		light->set_use_mis(light_params.use_mis);
+	}
+	else if (is_area_light_type(light_params.type) == false) {
+		light->set_use_mis(rend_params.light_use_mis);
+	}
+	light->set_samples(light_params.samples);
+	light->set_max_bounces(light_params.max_bounces);
+	light->set_use_diffuse(light_params.use_diffuse);
+	light->set_use_glossy(light_params.use_glossy);
+	light->set_use_transmission(light_params.use_transmission);
+
 	light->set_cast_shadow(light_params.shadows_enabled);
 
 	light->tag_update(scene);
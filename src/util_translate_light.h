@@ -28,6 +28,7 @@
 
 #include "trans_output.h"
 
+class CyclesRenderParams;
 class INode;
 class MaxShaderManager;
 class Object;
@@ -44,4 +45,4 @@ CyclesLightParams get_light_params(INode* node, Object* object, TimeValue t);
 /**
  * @brief Adds a light to a ccl::Scene
  */
-void add_light_to_scene(ccl::Scene* scene, const std::unique_ptr<MaxShaderManager>& shader_manager, CyclesLightParams light_params, float point_light_size);
+void add_light_to_scene(ccl::Scene* scene, const std::unique_ptr<MaxShaderManager>& shader_manager, CyclesLightParams light_params, const CyclesRenderParams& rend_params);
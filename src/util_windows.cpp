@@ -19,6 +19,7 @@
 
 #include <UserEnv.h>
 #include <Windows.h>
+#include <Psapi.h>
 
 bool create_directory(const std::wstring dir)
 {
@@ -43,3 +44,29 @@ std::wstring get_user_dir()
 
 	return std::wstring(path_buffer);
 }
+
+std::string utf8_from_wstring(const std::wstring& input)
+{
+	if (input.empty()) {
+		return std::string();
+	}
+
+	const int input_length = static_cast<int>(input.size());
+	const int result_length = WideCharToMultiByte(CP_UTF8, 0, input.c_str(), input_length, nullptr, 0, nullptr, nullptr);
+	if (result_length <= 0) {
+		return std::string();
+	}
+
+	std::string result(static_cast<size_t>(result_length), '\0');
+	WideCharToMultiByte(CP_UTF8, 0, input.c_str(), input_length, &result[0], result_length, nullptr, nullptr);
+	return result;
+}
+
+size_t get_memory_usage()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return counters.WorkingSetSize;
+	}
+	return 0;
+}
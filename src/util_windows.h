@@ -22,6 +22,7 @@
  * @brief Defines simple interfaces to some windows API functions.
  */
 
+#include <cstddef>
 #include <string>
 
 /**
@@ -33,3 +34,13 @@ bool create_directory(std::wstring dir);
  * @brief Returns the current user's home directory.
  */
 std::wstring get_user_dir();
+
+/**
+ * @brief Returns the current working set of this process in bytes, or 0 if it could not be queried.
+ */
+size_t get_memory_usage();
+
+/**
+ * @brief Converts a wide string to UTF-8.
+ */
+std::string utf8_from_wstring(const std::wstring& input);
@@ -88,6 +88,7 @@
 #define IDS_SUBSURFACE_METHOD           152
 #define IDS_EMISSION                    153
 #define IDS_ALPHA                       154
+#define IDS_PARTICLE_SPHERES            155
 #define IDS_MATERIAL_A                  200
 #define IDS_MATERIAL_B                  201
 #define IDS_SURFACE_MATERIAL            202
@@ -688,6 +689,7 @@
 #define IDC_RADIO_DISPLACE_BUMP         9071
 #define IDC_RADIO_DISPLACE_DISPLACE     9072
 #define IDC_RADIO_DISPLACE_BOTH         9073
+#define IDC_BOOL_PROP_PARTICLE_SPHERES  9074
 
 // Next default values for new objects
 // 
@@ -695,7 +697,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        127
 #define _APS_NEXT_COMMAND_VALUE         40001
-#define _APS_NEXT_CONTROL_VALUE         9072
+#define _APS_NEXT_CONTROL_VALUE         9075
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
 #endif